@@ -5,9 +5,11 @@ in vec2 _tex_coords;
 
 out vec4 FragmentColour;
 
-uniform sampler2D texture_data;
+// one byte per pixel, bit n set when bitplane n is lit
+uniform usampler2D texture_data;
+uniform vec4 palette[16];
 
 void main() {
-  vec4 c = texture(texture_data, _tex_coords);
-  FragmentColour = vec4(c.r*50, c.r*150, c.r*20, 255);
+  uint planes = texture(texture_data, _tex_coords).r;
+  FragmentColour = palette[planes & 15u];
 }
@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec3 attr_pos;
+layout (location = 2) in vec2 attr_tex_coords;
+
+out vec3 _tex_coords;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform ivec2 grid; // columns, rows
+uniform vec2 tile_size;
+
+void main() {
+  int col = gl_InstanceID % grid.x;
+  int row = grid.y - 1 - (gl_InstanceID / grid.x);
+
+  // leave a one pixel gap between tiles
+  vec2 pos = vec2(col, row) * tile_size + attr_pos.xy * (tile_size - 1.0);
+
+  gl_Position = projection * view * vec4(pos, 0.0, 1.0);
+  _tex_coords = vec3(attr_tex_coords.x, 1 - attr_tex_coords.y, gl_InstanceID);
+}
@@ -0,0 +1,164 @@
+#include <array>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../render/display.hpp"
+#include "frame_writer.hpp"
+
+using yuv_t = std::array<uint8_t, 3>;
+using yuv_palette_t = std::array<yuv_t, 1 << render::max_planes>;
+
+static yuv_palette_t yuv_palette();
+
+capture::FrameWriter::FrameWriter(
+  const std::string &path, const format_t format, const std::size_t scale,
+  const std::size_t queue_size
+) : format(format), scale(scale == 0 ? 1 : scale),
+    slots(queue_size == 0 ? 1 : queue_size) {
+  // a closed pipe should fail the write rather than kill the emulator
+  std::signal(SIGPIPE, SIG_IGN);
+
+  if (path == "-") {
+    out = stdout;
+  } else {
+    out = std::fopen(path.c_str(), "wb");
+    owns_out = true;
+  }
+  failed = (out == nullptr);
+
+  thread = std::thread(&FrameWriter::run, this);
+}
+
+capture::FrameWriter::~FrameWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  not_empty.notify_one();
+  thread.join();
+
+  if (out != nullptr) {
+    std::fflush(out);
+    if (owns_out) {
+      std::fclose(out);
+    }
+  }
+}
+
+bool capture::FrameWriter::good() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return !failed;
+}
+
+void capture::FrameWriter::push(const qch_vm::machine &m) {
+  if (mode.planes == 0) {
+    mode = render::current_display_mode(m);
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  if (failed) { return; }
+  not_full.wait(lock, [this](){ return count < slots.size(); });
+
+  render::pack_planes(m, mode, slots[(head + count) % slots.size()]);
+  count++;
+
+  lock.unlock();
+  not_empty.notify_one();
+}
+
+void capture::FrameWriter::run() {
+  std::vector<uint8_t> planes;
+  bool header_written = false;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      not_empty.wait(lock, [this](){ return count > 0 || stopping; });
+      if (count == 0) { return; }
+
+      // take the buffer, leaving the slot with the one we just finished
+      std::swap(planes, slots[head]);
+      head = (head + 1) % slots.size();
+      count--;
+    }
+    not_full.notify_one();
+
+    if (out == nullptr) { continue; }
+
+    if (!header_written && format == format_t::y4m) {
+      std::fprintf(
+        out, "YUV4MPEG2 W%zu H%zu F%d:1 Ip A1:1 C444\n",
+        mode.width * scale, mode.height * scale, frame_rate
+      );
+      header_written = true;
+    }
+
+    write_frame(planes);
+
+    if (std::fflush(out) != 0 || std::ferror(out)) {
+      std::lock_guard<std::mutex> lock(mutex);
+      failed = true;
+      count = 0;
+      not_full.notify_all();
+      return;
+    }
+  }
+}
+
+void capture::FrameWriter::write_frame(const std::vector<uint8_t> &planes) {
+  static const auto yuv = yuv_palette();
+
+  const std::size_t w = mode.width * scale;
+  const std::size_t h = mode.height * scale;
+  const std::size_t channels = 3;
+  frame.resize(w * h * channels);
+
+  // y4m frames are planar, raw rgb is interleaved
+  const std::size_t plane_stride = (format == format_t::y4m) ? w * h : 1;
+  const std::size_t pixel_stride = (format == format_t::y4m) ? 1 : channels;
+
+  for (std::size_t y = 0; y < h; y++) {
+    const uint8_t *src = planes.data() + ((y / scale) * mode.width);
+    for (std::size_t x = 0; x < w; x++) {
+      const uint8_t index = src[x / scale] & 0xf;
+      const uint8_t *c = (format == format_t::y4m)
+        ? yuv[index].data()
+        : render::palette[index].data();
+
+      const std::size_t p = (y*w + x) * pixel_stride;
+      for (std::size_t k = 0; k < channels; k++) {
+        frame[p + k*plane_stride] = c[k];
+      }
+    }
+  }
+
+  if (format == format_t::y4m) {
+    std::fputs("FRAME\n", out);
+  }
+  std::fwrite(frame.data(), 1, frame.size(), out);
+}
+
+// bt.601 limited range
+static yuv_palette_t yuv_palette() {
+  yuv_palette_t yuv;
+
+  for (std::size_t i = 0; i < yuv.size(); i++) {
+    const double r = render::palette[i][0];
+    const double g = render::palette[i][1];
+    const double b = render::palette[i][2];
+
+    yuv[i][0] = 16.5 + (65.481*r + 128.553*g + 24.966*b) / 255.0;
+    yuv[i][1] = 128.5 + (-37.797*r - 74.203*g + 112.0*b) / 255.0;
+    yuv[i][2] = 128.5 + (112.0*r - 93.786*g - 18.214*b) / 255.0;
+  }
+
+  return yuv;
+}
@@ -0,0 +1,68 @@
+#ifndef __FRAME_WRITER_HPP__
+#define __FRAME_WRITER_HPP__
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../render/display.hpp"
+
+namespace capture {
+  enum class format_t {
+    y4m, // yuv 4:4:4, 60 fps
+    rgb  // raw rgb24, no header
+  };
+
+  static constexpr int frame_rate = 60;
+
+  // streams frames to a file, fifo or stdout ("-") from a writer thread
+  // frames are queued as packed bitplanes; scaling, colour conversion and
+  // i/o all happen off the emulation thread
+  class FrameWriter {
+  public:
+    FrameWriter(
+      const std::string &path, const format_t format, const std::size_t scale,
+      const std::size_t queue_size=64
+    );
+    ~FrameWriter();
+
+    FrameWriter(const FrameWriter &) = delete;
+    FrameWriter &operator=(const FrameWriter &) = delete;
+
+    // false once the output could not be opened or a write failed
+    bool good() const;
+
+    // queues the current framebuffer, only waits if the queue is full
+    void push(const qch_vm::machine &m);
+  private:
+    void run();
+    void write_frame(const std::vector<uint8_t> &planes);
+
+    std::FILE *out = nullptr;
+    bool owns_out = false;
+    format_t format;
+    std::size_t scale;
+
+    // geometry is fixed by the first frame, streams cannot change size
+    render::display_mode mode;
+    std::vector<uint8_t> frame;
+
+    std::vector<std::vector<uint8_t>> slots;
+    std::size_t head = 0;
+    std::size_t count = 0;
+    bool stopping = false;
+    bool failed = false;
+    mutable std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::thread thread;
+  };
+}
+
+#endif // __FRAME_WRITER_HPP__
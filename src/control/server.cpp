@@ -0,0 +1,310 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../emu/cycle.hpp"
+#include "../emu/state.hpp"
+#include "../util/error.hpp"
+#include "server.hpp"
+
+static constexpr std::size_t header_size = 1 + 4;
+
+static void put_le(std::vector<uint8_t> &out, uint64_t v, const std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    out.push_back(v & 0xff);
+    v >>= 8;
+  }
+}
+
+static uint64_t get_le(const uint8_t *in, const std::size_t n) {
+  uint64_t v = 0;
+  for (std::size_t i = n; i-- > 0;) {
+    v = (v << 8) | in[i];
+  }
+  return v;
+}
+
+static void set_nonblocking(const int fd) {
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+control::Server::Server(const std::string &path) : path(path) {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    return;
+  }
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+  listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0) {
+    return;
+  }
+
+  unlink(path.c_str());
+  if (bind(listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0
+    || listen(listen_fd, 16) != 0) {
+    close(listen_fd);
+    listen_fd = -1;
+    return;
+  }
+  set_nonblocking(listen_fd);
+}
+
+control::Server::~Server() {
+  for (const client &c : clients) {
+    close(c.fd);
+  }
+  if (listen_fd >= 0) {
+    close(listen_fd);
+    unlink(path.c_str());
+  }
+}
+
+bool control::Server::good() const {
+  return listen_fd >= 0;
+}
+
+bool control::Server::connected() const {
+  return !clients.empty();
+}
+
+bool control::Server::paused() const {
+  return std::any_of(
+    clients.begin(), clients.end(), [](const client &c){ return c.paused; }
+  );
+}
+
+bool control::Server::service(
+  qch_vm::machine &m, emu::virtual_clock &clock, const int timeout_ms
+) {
+  if (listen_fd < 0) {
+    return false;
+  }
+
+  std::vector<pollfd> fds;
+  fds.push_back({listen_fd, POLLIN, 0});
+  for (const client &c : clients) {
+    fds.push_back({c.fd, static_cast<short>(
+      POLLIN | (c.out.empty() ? 0 : POLLOUT)
+    ), 0});
+  }
+  if (poll(fds.data(), fds.size(), timeout_ms) <= 0) {
+    return false;
+  }
+
+  machine = &m;
+  this->clock = &clock;
+  replaced = false;
+
+  // fds[i + 1] belongs to clients[i], accepted clients are appended after
+  std::vector<bool> dropped(clients.size(), false);
+  for (std::size_t i = 0; i < clients.size() && i + 1 < fds.size(); i++) {
+    const short events = fds[i + 1].revents;
+    if (events & (POLLIN | POLLHUP | POLLERR)) {
+      dropped[i] = !read_client(clients[i]);
+    }
+    if (!dropped[i] && !clients[i].out.empty()) {
+      dropped[i] = !write_client(clients[i]);
+    }
+  }
+
+  for (std::size_t i = clients.size(); i-- > 0;) {
+    if (dropped[i]) {
+      close(clients[i].fd);
+      clients.erase(clients.begin() + i);
+    }
+  }
+
+  if (fds[0].revents & POLLIN) {
+    int fd;
+    while ((fd = accept(listen_fd, nullptr, nullptr)) >= 0) {
+      set_nonblocking(fd);
+      clients.push_back({fd, {}, {}, false});
+    }
+  }
+
+  machine = nullptr;
+  this->clock = nullptr;
+  return replaced;
+}
+
+bool control::Server::read_client(client &c) {
+  uint8_t buffer[4096];
+  for (;;) {
+    const ssize_t n = read(c.fd, buffer, sizeof(buffer));
+    if (n > 0) {
+      c.in.insert(c.in.end(), buffer, buffer + n);
+    } else if (n == 0) {
+      return false;
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      break;
+    } else if (errno != EINTR) {
+      return false;
+    }
+  }
+
+  std::size_t pos = 0;
+  while (c.in.size() - pos >= header_size) {
+    const std::size_t size = get_le(c.in.data() + pos + 1, 4);
+    if (size > max_payload) {
+      return false;
+    }
+    if (c.in.size() - pos < header_size + size) {
+      break;
+    }
+    execute(c, c.in[pos], c.in.data() + pos + header_size, size);
+    pos += header_size + size;
+  }
+  c.in.erase(c.in.begin(), c.in.begin() + pos);
+
+  return true;
+}
+
+bool control::Server::write_client(client &c) {
+  std::size_t sent = 0;
+  while (sent < c.out.size()) {
+    const ssize_t n = send(
+      c.fd, c.out.data() + sent, c.out.size() - sent, MSG_NOSIGNAL
+    );
+    if (n > 0) {
+      sent += n;
+    } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    } else if (n < 0 && errno == EINTR) {
+      continue;
+    } else {
+      return false;
+    }
+  }
+  c.out.erase(c.out.begin(), c.out.begin() + sent);
+
+  return true;
+}
+
+void control::Server::execute(
+  client &c, const uint8_t command, const uint8_t *payload,
+  const std::size_t size
+) {
+  qch_vm::machine &m = *machine;
+  std::vector<uint8_t> reply;
+  status_t status = status_t::ok;
+
+  switch (static_cast<command_t>(command)) {
+    case command_t::load_rom:
+      if (size == 0 || size > m.memory.size() - emu::program_start) {
+        status = status_t::bad_request;
+        break;
+      }
+      m = qch_vm::machine{};
+      qch_vm::load_program(m, std::vector<uint8_t>(payload, payload + size));
+      m.draw = true;
+      *clock = {};
+      replaced = true;
+      break;
+    case command_t::step: {
+      if (size != 8) {
+        status = status_t::bad_request;
+        break;
+      }
+      const uint64_t cycles = std::min(get_le(payload, 8), max_step_cycles);
+      uint64_t run = 0;
+      while (run < cycles && !m.quit) {
+        emu::step(m, *clock);
+        run++;
+      }
+      put_le(reply, run, 8);
+      break;
+    }
+    case command_t::set_keys:
+      if (size != 2) {
+        status = status_t::bad_request;
+        break;
+      }
+      emu::set_key_mask(m, get_le(payload, 2));
+      break;
+    case command_t::registers:
+      reply.insert(reply.end(), std::begin(m.V), std::end(m.V));
+      put_le(reply, m.I, 2);
+      put_le(reply, m.pc, 2);
+      put_le(reply, m.sp, 1);
+      put_le(reply, m.delay_timer, 1);
+      put_le(reply, m.sound_timer, 1);
+      put_le(
+        reply,
+        (m.blocking ? 1 : 0) | (m.halted ? 2 : 0) | (m.quit ? 4 : 0)
+          | (m.draw ? 8 : 0),
+        1
+      );
+      put_le(reply, clock->cycles, 8);
+      put_le(reply, clock->frames, 8);
+      break;
+    case command_t::read_memory: {
+      if (size != 4) {
+        status = status_t::bad_request;
+        break;
+      }
+      const std::size_t address = get_le(payload, 2);
+      const std::size_t length = get_le(payload + 2, 2);
+      if (address + length > m.memory.size()) {
+        status = status_t::bad_request;
+        break;
+      }
+      reply.insert(
+        reply.end(), m.memory.begin() + address,
+        m.memory.begin() + address + length
+      );
+      break;
+    }
+    case command_t::framebuffer: {
+      const std::size_t width = m.display_width;
+      const std::size_t height = m.display_height;
+      put_le(reply, width, 2);
+      put_le(reply, height, 2);
+      for (std::size_t i = 0; i < width * height; i++) {
+        reply.push_back(m.gfx[i] ? 1 : 0);
+      }
+      break;
+    }
+    case command_t::save_state:
+      reply.resize(emu::state_size());
+      emu::save_state(m, reply.data());
+      break;
+    case command_t::load_state:
+      if (size != emu::state_size()) {
+        status = status_t::bad_request;
+        break;
+      }
+      emu::restore_state(m, payload);
+      m.draw = true;
+      replaced = true;
+      break;
+    case command_t::pause:
+      if (size != 1) {
+        status = status_t::bad_request;
+        break;
+      }
+      c.paused = payload[0] != 0;
+      break;
+    default:
+      status = status_t::unknown_command;
+      break;
+  }
+
+  c.out.push_back(to_underlying(status));
+  put_le(c.out, reply.size(), 4);
+  c.out.insert(c.out.end(), reply.begin(), reply.end());
+}
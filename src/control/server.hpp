@@ -0,0 +1,97 @@
+#ifndef __SERVER_HPP__
+#define __SERVER_HPP__
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../emu/cycle.hpp"
+
+namespace control {
+  // requests are u8 command, u32 payload size, payload; every request gets
+  // one reply of u8 status, u32 payload size, payload. Integers are little
+  // endian.
+  enum class command_t : uint8_t {
+    load_rom = 1,    // program bytes; resets the machine and clock
+    step = 2,        // u64 cycles; replies u64 cycles run, at most
+                     // max_step_cycles and less on quit
+    set_keys = 3,    // u16 key mask, bit k = key k
+    registers = 4,   // replies V0-VF, u16 I, u16 pc, u8 sp, u8 delay,
+                     // u8 sound, u8 flags (blocking, halted, quit, draw),
+                     // u64 cycles, u64 frames
+    read_memory = 5, // u16 address, u16 length; replies the bytes
+    framebuffer = 6, // replies u16 width, u16 height, a byte per pixel
+    save_state = 7,  // replies the emu::save_state bytes
+    load_state = 8,  // emu::save_state bytes
+    pause = 9        // u8, 1 stops wall clock pacing, 0 resumes it
+  };
+
+  enum class status_t : uint8_t {
+    ok = 0,
+    unknown_command = 1,
+    bad_request = 2
+  };
+
+  // largest accepted request payload, bigger requests drop the client
+  static constexpr std::size_t max_payload = 1 << 20;
+
+  // most cycles one step request runs, so a single client cannot stall the
+  // main loop; clients repeat the request for longer runs
+  static constexpr uint64_t max_step_cycles = 1 << 18;
+
+  // non-blocking unix domain socket server for automation clients
+  class Server {
+  public:
+    // replaces a stale socket file at `path`
+    Server(const std::string &path);
+    ~Server();
+
+    Server(const Server &) = delete;
+    Server &operator=(const Server &) = delete;
+
+    bool good() const;
+
+    // accepts clients and runs every complete request, waiting up to
+    // `timeout_ms` for activity (0 returns at once, -1 waits)
+    // returns true when a client replaced the program or machine state
+    bool service(
+      qch_vm::machine &m, emu::virtual_clock &clock, const int timeout_ms=0
+    );
+
+    // the keypad belongs to clients while any is connected
+    bool connected() const;
+
+    // true while any connected client has paused wall clock pacing
+    bool paused() const;
+  private:
+    struct client {
+      int fd;
+      std::vector<uint8_t> in;
+      std::vector<uint8_t> out;
+      bool paused = false;
+    };
+
+    // false when the client has to be dropped
+    bool read_client(client &c);
+    bool write_client(client &c);
+
+    // runs one request, appending its reply to the client's output
+    void execute(
+      client &c, const uint8_t command, const uint8_t *payload,
+      const std::size_t size
+    );
+
+    std::string path;
+    int listen_fd = -1;
+    std::vector<client> clients;
+
+    // request context, only valid during service
+    qch_vm::machine *machine = nullptr;
+    emu::virtual_clock *clock = nullptr;
+    bool replaced = false;
+  };
+}
+
+#endif // __SERVER_HPP__
@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../emu/cycle.hpp"
+#include "../emu/state.hpp"
+#include "shared_state.hpp"
+
+// state bytes start on their own cache line
+static constexpr std::size_t block_size = 64;
+static constexpr std::size_t header_size
+  = (sizeof(control::shared_header) + block_size - 1) / block_size * block_size;
+
+control::SharedState::SharedState(const std::string &name)
+  : name(name.empty() || name[0] != '/' ? "/" + name : name)
+{
+  const std::vector<std::size_t> fields = emu::state_field_sizes();
+  const std::size_t size = emu::state_size();
+  if (fields.size() > max_state_fields) {
+    return;
+  }
+
+  const int fd = shm_open(this->name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return;
+  }
+
+  segment_size = header_size + size;
+  if (ftruncate(fd, segment_size) != 0) {
+    close(fd);
+    shm_unlink(this->name.c_str());
+    return;
+  }
+
+  void *p = mmap(
+    nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0
+  );
+  close(fd);
+  if (p == MAP_FAILED) {
+    shm_unlink(this->name.c_str());
+    return;
+  }
+
+  segment = static_cast<uint8_t *>(p);
+  header = new (segment) shared_header{};
+  std::memcpy(header->magic, "QCSM", 4);
+  header->version = shared_state_version;
+  header->header_size = header_size;
+  header->state_size = size;
+  header->field_count = fields.size();
+  std::copy(fields.begin(), fields.end(), header->field_sizes);
+  state = segment + header_size;
+
+  // the segment starts zeroed, so does the shadow copy
+  next.resize(size);
+  shadow.assign(size, 0);
+}
+
+control::SharedState::~SharedState() {
+  if (segment != nullptr) {
+    munmap(segment, segment_size);
+    shm_unlink(name.c_str());
+  }
+}
+
+bool control::SharedState::good() const {
+  return segment != nullptr;
+}
+
+void control::SharedState::publish(
+  const qch_vm::machine &m, const emu::virtual_clock &clock
+) {
+  if (segment == nullptr) {
+    return;
+  }
+
+  emu::save_state(m, next.data());
+
+  const uint32_t sequence = header->sequence.load(std::memory_order_relaxed);
+  header->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  header->cycles = clock.cycles;
+  header->instructions = clock.instructions;
+  header->frames = clock.frames;
+
+  // unchanged blocks are never written, so readers' cached copies of them
+  // stay valid
+  for (std::size_t offset = 0; offset < next.size(); offset += block_size) {
+    const std::size_t n = std::min(block_size, next.size() - offset);
+    if (std::memcmp(next.data() + offset, shadow.data() + offset, n) != 0) {
+      std::memcpy(state + offset, next.data() + offset, n);
+      std::memcpy(shadow.data() + offset, next.data() + offset, n);
+    }
+  }
+
+  header->sequence.store(sequence + 2, std::memory_order_release);
+}
@@ -0,0 +1,64 @@
+#ifndef __SHARED_STATE_HPP__
+#define __SHARED_STATE_HPP__
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../emu/cycle.hpp"
+
+namespace control {
+  static constexpr uint32_t shared_state_version = 1;
+  static constexpr std::size_t max_state_fields = 16;
+
+  // start of the posix shared memory segment, host byte order; the
+  // emu::save_state bytes follow at `header_size`
+  //
+  // `sequence` is a seqlock: it is odd while the writer updates the segment.
+  // Readers load it (acquire), retry while it is odd, copy what they need,
+  // then load it again and retry if it changed.
+  struct shared_header {
+    char magic[4]; // "QCSM"
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t state_size;
+    uint32_t field_count;
+    uint32_t field_sizes[max_state_fields]; // save_state order
+    std::atomic<uint32_t> sequence;
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t frames;
+  };
+
+  // mirrors the machine into a shared memory segment for tools on the same
+  // host; each publish only writes the 64 byte blocks of the state that
+  // changed since the previous one
+  class SharedState {
+  public:
+    // `name` is a shm_open name, a leading '/' is added when missing; the
+    // segment is removed again on destruction
+    SharedState(const std::string &name);
+    ~SharedState();
+
+    SharedState(const SharedState &) = delete;
+    SharedState &operator=(const SharedState &) = delete;
+
+    bool good() const;
+
+    void publish(const qch_vm::machine &m, const emu::virtual_clock &clock);
+  private:
+    std::string name;
+    uint8_t *segment = nullptr;
+    std::size_t segment_size = 0;
+    shared_header *header = nullptr;
+    uint8_t *state = nullptr;
+
+    std::vector<uint8_t> next;
+    std::vector<uint8_t> shadow; // what the segment holds
+  };
+}
+
+#endif // __SHARED_STATE_HPP__
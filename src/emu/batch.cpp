@@ -0,0 +1,366 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BATCH_AVX2
+#endif
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "batch.hpp"
+#include "cycle.hpp"
+#include "opcode_stats.hpp"
+#include "state.hpp"
+
+static constexpr std::size_t block = 32;
+
+// opcodes that behave the same in every chip-8 variant and touch only V, I
+// and pc; 8XY4 with VF as an operand depends on the order of the flag write
+static bool is_shared(const uint16_t op) {
+  const uint8_t x = (op >> 8) & 0xf;
+  const uint8_t y = (op >> 4) & 0xf;
+  const uint8_t n = op & 0xf;
+
+  switch (op >> 12) {
+    case 0x1: case 0x3: case 0x4: case 0x6: case 0x7: case 0xa: return true;
+    case 0x5: case 0x9: return n == 0;
+    case 0x8: return n == 0 || (n == 4 && x != 0xf && y != 0xf);
+    default: return false;
+  }
+}
+
+// conservative: anything outside the base instruction set may write memory
+static bool keeps_memory(const uint16_t op) {
+  switch (op >> 12) {
+    case 0x0: return op == 0x00e0 || op == 0x00ee;
+    case 0xf:
+      switch (op & 0xff) {
+        case 0x07: case 0x0a: case 0x15: case 0x18: case 0x1e: case 0x29:
+        case 0x65:
+          return true;
+        default:
+          return false;
+      }
+    default: return true;
+  }
+}
+
+struct kernel_args {
+  uint16_t op;
+  std::size_t stride;
+  uint8_t *v;
+  uint16_t *i;
+  uint16_t *pc;
+  const uint8_t *active;
+};
+
+static void run_shared_scalar(const kernel_args &a) {
+  const uint8_t x = (a.op >> 8) & 0xf;
+  const uint8_t y = (a.op >> 4) & 0xf;
+  const uint8_t nn = a.op & 0xff;
+  const uint16_t nnn = a.op & 0xfff;
+
+  for (std::size_t l = 0; l < a.stride; l++) {
+    if (!a.active[l]) { continue; }
+
+    uint8_t &vx = a.v[x * a.stride + l];
+    const uint8_t vy = a.v[y * a.stride + l];
+    uint16_t next = a.pc[l] + 2;
+
+    switch (a.op >> 12) {
+      case 0x1: next = nnn; break;
+      case 0x3: if (vx == nn) { next += 2; } break;
+      case 0x4: if (vx != nn) { next += 2; } break;
+      case 0x5: if (vx == vy) { next += 2; } break;
+      case 0x9: if (vx != vy) { next += 2; } break;
+      case 0x6: vx = nn; break;
+      case 0x7: vx += nn; break;
+      case 0x8:
+        if ((a.op & 0xf) == 0) {
+          vx = vy;
+        } else {
+          const unsigned sum = vx + vy;
+          vx = sum & 0xff;
+          a.v[0xf * a.stride + l] = sum >> 8;
+        }
+        break;
+      case 0xa: a.i[l] = nnn; break;
+    }
+
+    a.pc[l] = next;
+  }
+}
+
+#ifdef BATCH_AVX2
+__attribute__((target("avx2")))
+static inline __m256i load(const void *p) {
+  return _mm256_loadu_si256(static_cast<const __m256i *>(p));
+}
+
+__attribute__((target("avx2")))
+static inline void store(void *p, const __m256i r) {
+  _mm256_storeu_si256(static_cast<__m256i *>(p), r);
+}
+
+__attribute__((target("avx2")))
+static void run_shared_avx2(const kernel_args &a) {
+  const uint8_t x = (a.op >> 8) & 0xf;
+  const uint8_t y = (a.op >> 4) & 0xf;
+  const uint8_t group = a.op >> 12;
+  const __m256i nn = _mm256_set1_epi8(static_cast<char>(a.op & 0xff));
+  const __m256i nnn = _mm256_set1_epi16(static_cast<short>(a.op & 0xfff));
+  const __m256i ones = _mm256_set1_epi8(-1);
+  const __m256i two = _mm256_set1_epi8(2);
+
+  for (std::size_t b = 0; b < a.stride; b += block) {
+    const __m256i act = load(a.active + b);
+    if (_mm256_testz_si256(act, act)) { continue; }
+
+    uint8_t *vx = a.v + x * a.stride + b;
+    uint8_t *vy = a.v + y * a.stride + b;
+    uint8_t *vf = a.v + 0xf * a.stride + b;
+    __m256i taken = _mm256_setzero_si256();
+
+    switch (group) {
+      case 0x3: taken = _mm256_cmpeq_epi8(load(vx), nn); break;
+      case 0x4: taken = _mm256_xor_si256(_mm256_cmpeq_epi8(load(vx), nn), ones); break;
+      case 0x5: taken = _mm256_cmpeq_epi8(load(vx), load(vy)); break;
+      case 0x9:
+        taken = _mm256_xor_si256(_mm256_cmpeq_epi8(load(vx), load(vy)), ones);
+        break;
+      case 0x6: store(vx, _mm256_blendv_epi8(load(vx), nn, act)); break;
+      case 0x7:
+        store(vx, _mm256_blendv_epi8(load(vx), _mm256_add_epi8(load(vx), nn), act));
+        break;
+      case 0x8:
+        if ((a.op & 0xf) == 0) {
+          store(vx, _mm256_blendv_epi8(load(vx), load(vy), act));
+        } else {
+          // a saturating add differs from the wrapping one exactly on carry
+          const __m256i sum = _mm256_add_epi8(load(vx), load(vy));
+          const __m256i carry = _mm256_andnot_si256(
+            _mm256_cmpeq_epi8(_mm256_adds_epu8(load(vx), load(vy)), sum),
+            _mm256_set1_epi8(1)
+          );
+          store(vx, _mm256_blendv_epi8(load(vx), sum, act));
+          store(vf, _mm256_blendv_epi8(load(vf), carry, act));
+        }
+        break;
+    }
+
+    // pc advances by 2, or 4 on a taken skip, in active lanes only
+    const __m256i inc = _mm256_and_si256(
+      act, _mm256_add_epi8(two, _mm256_and_si256(taken, two))
+    );
+
+    for (std::size_t h = 0; h < 2; h++) {
+      const __m128i inc_half = h
+        ? _mm256_extracti128_si256(inc, 1)
+        : _mm256_castsi256_si128(inc);
+      const __m128i act_half = h
+        ? _mm256_extracti128_si256(act, 1)
+        : _mm256_castsi256_si128(act);
+      const __m256i mask = _mm256_cvtepi8_epi16(act_half);
+      uint16_t *pc = a.pc + b + h * 16;
+      uint16_t *i = a.i + b + h * 16;
+
+      if (group == 0x1) {
+        store(pc, _mm256_blendv_epi8(load(pc), nnn, mask));
+      } else {
+        store(pc, _mm256_add_epi16(load(pc), _mm256_cvtepu8_epi16(inc_half)));
+      }
+
+      if (group == 0xa) {
+        store(i, _mm256_blendv_epi8(load(i), nnn, mask));
+      }
+    }
+  }
+}
+
+static const bool has_avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+emu::Batch::Batch(const std::vector<uint8_t> &program, const std::size_t lanes)
+  : lanes(lanes), stride((lanes + block - 1) / block * block)
+{
+  machines.resize(lanes);
+  for (auto &m : machines) {
+    qch_vm::load_program(m, program);
+  }
+  code = machines.empty() ? decltype(code){} : machines[0].memory;
+
+  v.assign(16 * stride, 0);
+  i.assign(stride, 0);
+  pc.assign(stride, 0);
+  delay.assign(stride, timer_t{});
+  sound.assign(stride, timer_t{});
+  random.assign(lanes, random_state());
+  clean.assign(stride, 0);
+  eligible.assign(stride, 0);
+  active.assign(stride, 0);
+  stopped.assign(stride, 0);
+  resident.assign(stride, 0);
+
+  for (std::size_t l = 0; l < lanes; l++) {
+    clean[l] = 0xff;
+    load(l);
+    update_flags(l);
+  }
+}
+
+std::size_t emu::Batch::size() const {
+  return lanes;
+}
+
+const emu::virtual_clock &emu::Batch::clock() const {
+  return slot_clock;
+}
+
+uint64_t emu::Batch::vector_cycles() const {
+  return vector_count;
+}
+
+uint64_t emu::Batch::scalar_cycles() const {
+  return scalar_count;
+}
+
+void emu::Batch::set_key(
+  const std::size_t lane, const uint8_t key, const bool pressed
+) {
+  machines[lane].keys[key] = pressed;
+}
+
+const qch_vm::machine &emu::Batch::machine(const std::size_t lane) {
+  if (resident[lane]) {
+    store(lane);
+  }
+  return machines[lane];
+}
+
+void emu::Batch::store(const std::size_t lane) {
+  qch_vm::machine &m = machines[lane];
+  for (std::size_t x = 0; x < 16; x++) {
+    m.V[x] = v[x * stride + lane];
+  }
+  m.I = i[lane];
+  m.pc = pc[lane];
+  m.delay_timer = delay[lane];
+  m.sound_timer = sound[lane];
+}
+
+void emu::Batch::load(const std::size_t lane) {
+  const qch_vm::machine &m = machines[lane];
+  for (std::size_t x = 0; x < 16; x++) {
+    v[x * stride + lane] = m.V[x];
+  }
+  i[lane] = m.I;
+  pc[lane] = m.pc;
+  delay[lane] = m.delay_timer;
+  sound[lane] = m.sound_timer;
+  resident[lane] = 0xff;
+}
+
+void emu::Batch::update_flags(const std::size_t lane) {
+  const qch_vm::machine &m = machines[lane];
+  const bool runnable = !m.blocking && !m.halted && !m.quit;
+  eligible[lane] = (clean[lane] && runnable) ? 0xff : 0;
+}
+
+bool emu::Batch::step() {
+  // lanes sharing the pc of the first eligible lane run the opcode together
+  std::fill(active.begin(), active.end(), 0);
+  const auto leader = std::find(eligible.begin(), eligible.end(), 0xff);
+  std::size_t shared = 0;
+
+  if (leader != eligible.end()) {
+    const uint16_t leader_pc = pc[leader - eligible.begin()];
+    const std::size_t mask = code.size() - 1;
+    const uint16_t op = (code[leader_pc & mask] << 8)
+      | code[(leader_pc + 1) & mask];
+
+    if (is_shared(op)) {
+      for (std::size_t l = 0; l < lanes; l++) {
+        active[l] = (pc[l] == leader_pc) ? eligible[l] : 0;
+        shared += active[l] & 1;
+      }
+
+      // lanes rejoining from the scalar path bring their registers back
+      if (diverged > 0) {
+        for (std::size_t l = 0; l < lanes; l++) {
+          if (active[l] && !resident[l]) {
+            load(l);
+            diverged--;
+          }
+        }
+      }
+
+      const kernel_args args = {op, stride, v.data(), i.data(), pc.data(), active.data()};
+      #ifdef BATCH_AVX2
+      if (has_avx2) {
+        run_shared_avx2(args);
+      } else {
+        run_shared_scalar(args);
+      }
+      #else
+      run_shared_scalar(args);
+      #endif
+      count_opcode(op, shared);
+    }
+  }
+  vector_count += shared;
+
+  if (shared + stopped_count < lanes) {
+    for (std::size_t l = 0; l < lanes; l++) {
+      if (active[l] || stopped[l]) { continue; }
+
+      qch_vm::machine &m = machines[l];
+      if (m.quit) {
+        stopped[l] = 1;
+        stopped_count++;
+        continue;
+      }
+
+      if (resident[l]) {
+        store(l);
+        resident[l] = 0;
+        diverged++;
+      }
+
+      // only CXNN draws from the source, the other opcodes skip the swap
+      const uint16_t op = peek_opcode(m);
+      const bool draws = (op >> 12) == 0xc;
+      if (draws) { seed_random(random[l]); }
+      if (cycle(m)) {
+        if (!keeps_memory(op)) { clean[l] = 0; }
+      }
+      if (draws) { random[l] = random_state(); }
+      pc[l] = m.pc;
+      update_flags(l);
+      scalar_count++;
+    }
+  }
+
+  slot_clock.cycles++;
+  slot_clock.timer_phase += timer_frequency;
+  if (slot_clock.timer_phase >= cycles_per_second) {
+    slot_clock.timer_phase -= cycles_per_second;
+    slot_clock.frames++;
+
+    // lanes that quit stop ticking like a single machine run
+    for (std::size_t l = 0; l < lanes; l++) {
+      if (stopped[l]) { continue; }
+      if (resident[l]) {
+        --delay[l];
+        --sound[l];
+      } else {
+        tick_timers(machines[l]);
+      }
+    }
+    return true;
+  }
+
+  return false;
+}
@@ -0,0 +1,80 @@
+#ifndef __BATCH_HPP__
+#define __BATCH_HPP__
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "cycle.hpp"
+
+namespace emu {
+  // many copies of one program run in lockstep
+  //
+  // V, I, pc and the timers live in per register arrays indexed by lane, the
+  // rest of each machine stays in a full qch_vm::machine. Lanes that share
+  // the leading pc and still run unmodified code execute the common opcodes
+  // (jumps, skips, loads, 8XY0/8XY4, ANNN) together with avx2 when the cpu
+  // has it; every other lane and opcode goes through emu::cycle on its own
+  // machine, so results match single machine runs bit for bit. A lane that
+  // diverges keeps its registers in its machine until it rejoins.
+  //
+  // every lane has its own CXNN source, starting from this thread's
+  // emu::random_state when the batch is created
+  class Batch {
+  public:
+    Batch(const std::vector<uint8_t> &program, const std::size_t lanes);
+
+    std::size_t size() const;
+
+    // one cycle slot for every lane, returns true on a 60hz timer tick
+    bool step();
+
+    const virtual_clock &clock() const;
+
+    void set_key(const std::size_t lane, const uint8_t key, const bool pressed);
+
+    // full machine of one lane with the register arrays written back
+    const qch_vm::machine &machine(const std::size_t lane);
+
+    // lane cycles executed by the shared kernels and by emu::cycle
+    uint64_t vector_cycles() const;
+    uint64_t scalar_cycles() const;
+  private:
+    using timer_t = decltype(qch_vm::machine::delay_timer);
+
+    // move V, I and the timers between the arrays and the lane's machine,
+    // pc is always kept current in the array
+    void store(const std::size_t lane);
+    void load(const std::size_t lane);
+    void update_flags(const std::size_t lane);
+
+    std::size_t lanes;
+    std::size_t stride; // lanes rounded up to whole 32 lane blocks
+    std::vector<qch_vm::machine> machines;
+    decltype(qch_vm::machine::memory) code; // memory of every clean lane
+
+    std::vector<uint8_t> v; // V[x] of lane l at v[x * stride + l]
+    std::vector<uint16_t> i;
+    std::vector<uint16_t> pc;
+    std::vector<timer_t> delay;
+    std::vector<timer_t> sound;
+    std::vector<uint64_t> random; // CXNN source state of each lane
+
+    // 0xff while the lane has not written memory
+    std::vector<uint8_t> clean;
+    // 0xff when the lane is clean and not waiting, halted or quit
+    std::vector<uint8_t> eligible;
+    std::vector<uint8_t> active;
+    std::vector<uint8_t> stopped; // quit before the current slot
+    std::vector<uint8_t> resident; // registers currently live in the arrays
+    std::size_t stopped_count = 0;
+    std::size_t diverged = 0; // lanes that are not resident
+
+    virtual_clock slot_clock;
+    uint64_t vector_count = 0;
+    uint64_t scalar_count = 0;
+  };
+}
+
+#endif // __BATCH_HPP__
@@ -0,0 +1,99 @@
+#include <cstdint>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "cycle.hpp"
+#include "opcode_stats.hpp"
+#include "state.hpp"
+#include "trace.hpp"
+
+static thread_local uint64_t rng_state = emu::default_seed;
+static thread_local emu::TraceRing *active_trace = nullptr;
+static thread_local bool opcode_counting = true;
+
+static uint8_t next_random() {
+  rng_state ^= rng_state >> 12;
+  rng_state ^= rng_state << 25;
+  rng_state ^= rng_state >> 27;
+  return (rng_state * 0x2545f4914f6cdd1d) >> 56;
+}
+
+void emu::seed_random(const uint64_t seed) {
+  // xorshift never leaves zero
+  rng_state = seed ? seed : 0x9e3779b97f4a7c15;
+}
+
+uint64_t emu::random_state() {
+  return rng_state;
+}
+
+void emu::trace_to(TraceRing *ring) {
+  active_trace = ring;
+}
+
+emu::TraceRing *emu::tracing() {
+  return active_trace;
+}
+
+void emu::count_opcodes(const bool enabled) {
+  opcode_counting = enabled;
+}
+
+bool emu::counting_opcodes() {
+  return opcode_counting;
+}
+
+bool emu::cycle(qch_vm::machine &m) {
+  if (m.blocking) {
+    qch_vm::get_key(m);
+    return false;
+  }
+
+  if (m.halted) {
+    return false;
+  }
+
+  const uint16_t op = peek_opcode(m);
+  if (opcode_counting) {
+    count_opcode(op);
+  }
+  if ((op & 0xf000) == 0xc000) {
+    execute_random(m, op, next_random());
+    return true;
+  }
+
+  qch::instruction inst = qch_vm::fetch_instruction(m);
+  qch_vm::fn f = qch_vm::decode_instruction(inst);
+  f(m, inst);
+
+  return true;
+}
+
+void emu::tick_timers(qch_vm::machine &m) {
+  --m.delay_timer;
+  --m.sound_timer;
+}
+
+bool emu::step(qch_vm::machine &m, virtual_clock &clock) {
+  TraceRing *const trace = active_trace;
+  if (trace) {
+    trace->begin(m, clock.cycles);
+  }
+  if (cycle(m)) {
+    clock.instructions++;
+    if (trace) {
+      trace->commit(m);
+    }
+  }
+  clock.cycles++;
+
+  clock.timer_phase += timer_frequency;
+  if (clock.timer_phase >= cycles_per_second) {
+    clock.timer_phase -= cycles_per_second;
+    clock.frames++;
+    tick_timers(m);
+    return true;
+  }
+
+  return false;
+}
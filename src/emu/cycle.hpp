@@ -0,0 +1,38 @@
+#ifndef __CYCLE_HPP__
+#define __CYCLE_HPP__
+#include <cstdint>
+
+#include <qch_vm/qch_vm.hpp>
+
+namespace emu {
+  static constexpr uint64_t cycles_per_second = 500;
+  static constexpr uint64_t timer_frequency = 60;
+
+  // emulated time for runs that are not paced by the wall clock
+  struct virtual_clock {
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t timer_phase = 0;
+    uint64_t frames = 0; // 60hz timer ticks
+  };
+
+  // CXNN draws from a per thread xorshift source instead of the vm's own, so
+  // runs with the same seed and input are reproducible
+  static constexpr uint64_t default_seed = 1;
+  void seed_random(const uint64_t seed);
+
+  // current state of the CXNN source, seed_random(random_state()) resumes it
+  uint64_t random_state();
+
+  // runs one fetch/decode/execute cycle
+  // returns false when the machine is halted or waiting for a key
+  bool cycle(qch_vm::machine &m);
+
+  void tick_timers(qch_vm::machine &m);
+
+  // runs one cycle slot and ticks the timers on emulated time
+  // returns true when the slot ended on a 60hz timer tick (a frame boundary)
+  bool step(qch_vm::machine &m, virtual_clock &clock);
+}
+
+#endif // __CYCLE_HPP__
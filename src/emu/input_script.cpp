@@ -0,0 +1,53 @@
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <sstream>
+#include <string>
+
+#include "input_script.hpp"
+
+std::optional<emu::input_script> emu::parse_input_script(
+  const std::string &name, const std::string &text
+) {
+  input_script script;
+  script.name = name;
+
+  std::istringstream lines(text);
+  std::string line;
+  while (std::getline(lines, line)) {
+    line = line.substr(0, line.find('#'));
+    if (line.find_first_not_of(" \t\r") == std::string::npos) { continue; }
+
+    std::istringstream fields(line);
+    unsigned long long cycle;
+    unsigned key;
+    int pressed;
+    fields >> std::dec >> cycle >> std::hex >> key >> std::dec >> pressed;
+    if (!fields || key > 0xf || (pressed != 0 && pressed != 1)) {
+      return {};
+    }
+
+    script.events.push_back({cycle, static_cast<uint8_t>(key), pressed == 1});
+  }
+
+  std::stable_sort(
+    script.events.begin(), script.events.end(),
+    [](const input_event &a, const input_event &b){ return a.cycle < b.cycle; }
+  );
+
+  return script;
+}
+
+emu::InputPlayer::InputPlayer(const input_script *script) : script(script) {}
+
+void emu::InputPlayer::seek(const uint64_t cycle) {
+  if (script == nullptr) { return; }
+  cursor = std::lower_bound(
+    script->events.begin(), script->events.end(), cycle,
+    [](const input_event &e, const uint64_t c){ return e.cycle < c; }
+  ) - script->events.begin();
+}
+
+bool emu::InputPlayer::finished() const {
+  return script == nullptr || cursor >= script->events.size();
+}
@@ -0,0 +1,58 @@
+#ifndef __INPUT_SCRIPT_HPP__
+#define __INPUT_SCRIPT_HPP__
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+namespace emu {
+  struct input_event {
+    uint64_t cycle;
+    uint8_t key;
+    bool pressed;
+  };
+
+  // key changes applied at fixed cycles, used to drive unattended runs
+  //
+  // text format, one event per line, `#` starts a comment:
+  //   <cycle> <key, hex 0-f> <1 pressed | 0 released>
+  struct input_script {
+    std::string name;
+    std::vector<input_event> events;
+  };
+
+  // events are sorted by cycle, returns nothing on a malformed line
+  std::optional<input_script> parse_input_script(
+    const std::string &name, const std::string &text
+  );
+
+  // replays a script against one machine
+  class InputPlayer {
+  public:
+    InputPlayer(const input_script *script=nullptr);
+
+    // applies every event due at or before `cycle`
+    void apply(const uint64_t cycle, qch_vm::machine &m) {
+      if (script == nullptr) { return; }
+      while (cursor < script->events.size()
+        && script->events[cursor].cycle <= cycle) {
+        const input_event &e = script->events[cursor++];
+        m.keys[e.key] = e.pressed;
+      }
+    }
+
+    // moves to the first event at or after `cycle`, for runs restored to a
+    // state whose keys already reflect every earlier event
+    void seek(const uint64_t cycle);
+
+    bool finished() const;
+  private:
+    const input_script *script;
+    std::size_t cursor = 0;
+  };
+}
+
+#endif // __INPUT_SCRIPT_HPP__
@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "input_script.hpp"
+#include "movie.hpp"
+#include "state.hpp"
+
+static const char magic[4] = {'Q', 'C', 'H', 'M'};
+static constexpr std::size_t header_size = 4 + 2 + 8 + 8 + 4 + 4;
+static constexpr uint8_t end_marker = 0xff;
+
+static void put_le(std::ofstream &ofs, uint64_t v, const std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    ofs.put(static_cast<char>(v & 0xff));
+    v >>= 8;
+  }
+}
+
+static uint64_t get_le(const uint8_t *in, const std::size_t n) {
+  uint64_t v = 0;
+  for (std::size_t i = n; i-- > 0;) {
+    v = (v << 8) | in[i];
+  }
+  return v;
+}
+
+std::optional<emu::movie> emu::read_movie(const std::string &path) {
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs) { return {}; }
+
+  const std::vector<uint8_t> data(
+    (std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>()
+  );
+  if (data.size() < header_size
+    || !std::equal(std::begin(magic), std::end(magic), data.begin())
+    || get_le(&data[4], 2) != movie_version) {
+    return {};
+  }
+
+  movie mv;
+  mv.header.program_hash = get_le(&data[6], 8);
+  mv.header.seed = get_le(&data[14], 8);
+  mv.header.cycles_per_second = get_le(&data[22], 4);
+  mv.header.timer_frequency = get_le(&data[26], 4);
+  mv.inputs.name = path;
+
+  std::size_t pos = header_size;
+  auto get_varint = [&](uint64_t &v) {
+    v = 0;
+    for (std::size_t shift = 0; pos < data.size() && shift < 64; shift += 7) {
+      const uint8_t b = data[pos++];
+      v |= static_cast<uint64_t>(b & 0x7f) << shift;
+      if (!(b & 0x80)) { return true; }
+    }
+    return false;
+  };
+
+  // a file cut off mid event keeps everything before it
+  uint64_t cycle = 0;
+  while (pos < data.size()) {
+    uint64_t delta;
+    if (!get_varint(delta) || pos >= data.size()) { break; }
+    cycle += delta;
+
+    const uint8_t event = data[pos++];
+    if (event == end_marker) {
+      if (data.size() - pos < 8) { break; }
+      mv.end_cycle = cycle;
+      mv.end_hash = get_le(&data[pos], 8);
+      break;
+    }
+
+    mv.inputs.events.push_back({
+      cycle, static_cast<uint8_t>(event & 0xf), (event >> 4) != 0
+    });
+  }
+
+  return mv;
+}
+
+emu::MovieRecorder::MovieRecorder(
+  const std::string &path, const movie_header &header
+) : ofs(path, std::ios::binary | std::ios::trunc) {
+  ofs.write(magic, sizeof(magic));
+  put_le(ofs, movie_version, 2);
+  put_le(ofs, header.program_hash, 8);
+  put_le(ofs, header.seed, 8);
+  put_le(ofs, header.cycles_per_second, 4);
+  put_le(ofs, header.timer_frequency, 4);
+}
+
+bool emu::MovieRecorder::good() const {
+  return ofs.good();
+}
+
+void emu::MovieRecorder::put_delta(const uint64_t cycle) {
+  uint64_t delta = cycle - last_cycle;
+  while (delta >= 0x80) {
+    ofs.put(static_cast<char>((delta & 0x7f) | 0x80));
+    delta >>= 7;
+  }
+  ofs.put(static_cast<char>(delta));
+  last_cycle = cycle;
+}
+
+void emu::MovieRecorder::record(const uint64_t cycle, const qch_vm::machine &m) {
+  if (finished) { return; }
+
+  const uint16_t next = key_mask(m);
+  const uint16_t changed = next ^ keys;
+  for (uint8_t k = 0; k < 16; k++) {
+    if (!((changed >> k) & 1)) { continue; }
+
+    put_delta(cycle);
+    ofs.put(static_cast<char>((((next >> k) & 1) << 4) | k));
+  }
+  keys = next;
+}
+
+void emu::MovieRecorder::finish(const uint64_t cycle, const qch_vm::machine &m) {
+  if (finished) { return; }
+
+  put_delta(cycle);
+  ofs.put(static_cast<char>(end_marker));
+  put_le(ofs, state_hash(m), 8);
+  ofs.flush();
+  finished = true;
+}
@@ -0,0 +1,59 @@
+#ifndef __MOVIE_HPP__
+#define __MOVIE_HPP__
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "input_script.hpp"
+
+namespace emu {
+  static constexpr uint16_t movie_version = 1;
+
+  struct movie_header {
+    uint64_t program_hash = 0;
+    uint64_t seed = 0;
+    uint32_t cycles_per_second = 0;
+    uint32_t timer_frequency = 0;
+  };
+
+  // a recorded run: every key change at the cycle it took effect
+  struct movie {
+    movie_header header;
+    input_script inputs;
+    std::optional<uint64_t> end_cycle; // missing when recording was cut off
+    uint64_t end_hash = 0; // state_hash at end_cycle
+  };
+
+  // binary file, little endian:
+  //   "QCHM", u16 version, u64 program hash, u64 seed,
+  //   u32 cycles per second, u32 timer frequency,
+  //   events of varint cycle delta, u8 (pressed << 4 | key),
+  //   then varint cycle delta, u8 0xff, u64 final state hash
+  std::optional<movie> read_movie(const std::string &path);
+
+  class MovieRecorder {
+  public:
+    MovieRecorder(const std::string &path, const movie_header &header);
+
+    bool good() const;
+
+    // records every key that changed since the previous call
+    void record(const uint64_t cycle, const qch_vm::machine &m);
+
+    // writes the end marker, nothing is recorded afterwards
+    void finish(const uint64_t cycle, const qch_vm::machine &m);
+  private:
+    void put_delta(const uint64_t cycle);
+
+    std::ofstream ofs;
+    uint64_t last_cycle = 0;
+    uint16_t keys = 0;
+    bool finished = false;
+  };
+}
+
+#endif // __MOVIE_HPP__
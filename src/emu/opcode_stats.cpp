@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "opcode_stats.hpp"
+
+static constexpr std::size_t opcode_count = 0x10000;
+
+// exact opcodes listed in the text report, the json one has all of them
+static constexpr std::size_t text_opcodes = 32;
+
+#ifdef OPCODE_STATS
+using table_t = std::array<uint64_t, opcode_count>;
+
+static std::mutex tables_mutex;
+static std::vector<std::unique_ptr<table_t>> tables;
+
+uint64_t *emu::opcode_table() {
+  auto table = std::make_unique<table_t>();
+  table->fill(0);
+
+  std::lock_guard<std::mutex> lock(tables_mutex);
+  tables.push_back(std::move(table));
+  return tables.back()->data();
+}
+#endif
+
+std::vector<uint64_t> emu::opcode_counts() {
+  std::vector<uint64_t> counts;
+  #ifdef OPCODE_STATS
+  counts.assign(opcode_count, 0);
+  std::lock_guard<std::mutex> lock(tables_mutex);
+  for (const auto &table : tables) {
+    for (std::size_t op = 0; op < opcode_count; op++) {
+      counts[op] += (*table)[op];
+    }
+  }
+  #endif
+  return counts;
+}
+
+std::string emu::opcode_class(const uint16_t op) {
+  static const char hex[] = "0123456789ABCDEF";
+  const char first = hex[op >> 12];
+
+  switch (op >> 12) {
+    case 0x0:
+      if (op == 0x00e0) { return "00E0"; }
+      if (op == 0x00ee) { return "00EE"; }
+      return "0NNN";
+    case 0x1: case 0x2: case 0xa: case 0xb:
+      return std::string(1, first) + "NNN";
+    case 0x3: case 0x4: case 0x6: case 0x7: case 0xc:
+      return std::string(1, first) + "XNN";
+    case 0x5: case 0x8: case 0x9:
+      return std::string(1, first) + "XY" + hex[op & 0xf];
+    case 0xd:
+      return "DXYN";
+    default:
+      return std::string(1, first) + "X" + hex[(op >> 4) & 0xf] + hex[op & 0xf];
+  }
+}
+
+// non-zero entries, largest first, ties by key
+template <typename K>
+static std::vector<std::pair<K, uint64_t>> sorted_counts(
+  const std::vector<std::pair<K, uint64_t>> &entries
+) {
+  std::vector<std::pair<K, uint64_t>> out;
+  for (const auto &e : entries) {
+    if (e.second > 0) { out.push_back(e); }
+  }
+  std::sort(out.begin(), out.end(), [](const auto &a, const auto &b){
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+  });
+  return out;
+}
+
+static std::vector<std::pair<std::string, uint64_t>> class_counts(
+  const std::vector<uint64_t> &counts
+) {
+  std::vector<std::pair<std::string, uint64_t>> classes;
+  for (std::size_t op = 0; op < counts.size(); op++) {
+    if (counts[op] == 0) { continue; }
+    const std::string name = emu::opcode_class(op);
+    auto it = std::find_if(classes.begin(), classes.end(),
+      [&](const auto &c){ return c.first == name; });
+    if (it == classes.end()) {
+      classes.push_back({name, counts[op]});
+    } else {
+      it->second += counts[op];
+    }
+  }
+  return sorted_counts(classes);
+}
+
+static std::vector<std::pair<uint16_t, uint64_t>> exact_counts(
+  const std::vector<uint64_t> &counts
+) {
+  std::vector<std::pair<uint16_t, uint64_t>> opcodes;
+  for (std::size_t op = 0; op < counts.size(); op++) {
+    opcodes.push_back({static_cast<uint16_t>(op), counts[op]});
+  }
+  return sorted_counts(opcodes);
+}
+
+static uint64_t total(const std::vector<uint64_t> &counts) {
+  uint64_t sum = 0;
+  for (const uint64_t n : counts) { sum += n; }
+  return sum;
+}
+
+std::string emu::opcode_report_text(const std::vector<uint64_t> &counts) {
+  const uint64_t sum = total(counts);
+  const double scale = sum > 0 ? 100.0 / sum : 0.0;
+  char line[96];
+  std::string out;
+
+  std::snprintf(
+    line, sizeof(line), "opcodes executed: %llu\n",
+    static_cast<unsigned long long>(sum)
+  );
+  out += line;
+
+  out += "by class:\n";
+  for (const auto &[name, n] : class_counts(counts)) {
+    std::snprintf(
+      line, sizeof(line), "  %-4s %14llu %6.2f%%\n", name.c_str(),
+      static_cast<unsigned long long>(n), n * scale
+    );
+    out += line;
+  }
+
+  out += "top opcodes:\n";
+  const auto opcodes = exact_counts(counts);
+  for (std::size_t i = 0; i < opcodes.size() && i < text_opcodes; i++) {
+    const auto &[op, n] = opcodes[i];
+    std::snprintf(
+      line, sizeof(line), "  %04x %-4s %14llu %6.2f%%\n", op,
+      opcode_class(op).c_str(), static_cast<unsigned long long>(n), n * scale
+    );
+    out += line;
+  }
+
+  return out;
+}
+
+std::string emu::opcode_report_json(const std::vector<uint64_t> &counts) {
+  char line[96];
+  std::string out = "{\n";
+
+  std::snprintf(
+    line, sizeof(line), "  \"total\": %llu,\n",
+    static_cast<unsigned long long>(total(counts))
+  );
+  out += line;
+
+  out += "  \"classes\": [";
+  const auto classes = class_counts(counts);
+  for (std::size_t i = 0; i < classes.size(); i++) {
+    std::snprintf(
+      line, sizeof(line), "%s\n    {\"class\": \"%s\", \"count\": %llu}",
+      i > 0 ? "," : "", classes[i].first.c_str(),
+      static_cast<unsigned long long>(classes[i].second)
+    );
+    out += line;
+  }
+  out += "\n  ],\n";
+
+  out += "  \"opcodes\": [";
+  const auto opcodes = exact_counts(counts);
+  for (std::size_t i = 0; i < opcodes.size(); i++) {
+    const auto &[op, n] = opcodes[i];
+    std::snprintf(
+      line, sizeof(line),
+      "%s\n    {\"opcode\": \"%04x\", \"class\": \"%s\", \"count\": %llu}",
+      i > 0 ? "," : "", op, opcode_class(op).c_str(),
+      static_cast<unsigned long long>(n)
+    );
+    out += line;
+  }
+  out += "\n  ]\n}\n";
+
+  return out;
+}
+
+emu::OpcodeReport::OpcodeReport(const std::optional<std::string> &json_path)
+  : json_path(json_path) {}
+
+emu::OpcodeReport::~OpcodeReport() {
+  write();
+}
+
+void emu::OpcodeReport::write() const {
+  #ifdef OPCODE_STATS
+  const std::vector<uint64_t> counts = opcode_counts();
+  std::fputs(opcode_report_text(counts).c_str(), stderr);
+
+  if (json_path) {
+    std::ofstream ofs(*json_path);
+    ofs << opcode_report_json(counts);
+  }
+  #endif
+}
@@ -0,0 +1,54 @@
+#ifndef __OPCODE_STATS_HPP__
+#define __OPCODE_STATS_HPP__
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace emu {
+  // executions per exact opcode, only counted in builds with OPCODE_STATS
+  // (make OPCODE_STATS=1); otherwise count_opcode is empty and every report
+  // is skipped
+  #ifdef OPCODE_STATS
+  // this thread's table of 0x10000 counters, registered on first use so
+  // reports can sum every thread, including ones that already exited
+  uint64_t *opcode_table();
+
+  inline void count_opcode(const uint16_t op, const uint64_t n=1) {
+    static thread_local uint64_t *table = opcode_table();
+    table[op] += n;
+  }
+  #else
+  inline void count_opcode(const uint16_t, const uint64_t=1) {}
+  #endif
+
+  // false stops emu::cycle counting opcodes on this thread, for speculative
+  // runs that must not show up in the histogram
+  void count_opcodes(const bool enabled);
+  bool counting_opcodes();
+
+  // handler an opcode dispatches to, as a pattern like "8XY4" or "FX33"
+  std::string opcode_class(const uint16_t op);
+
+  // sum of every thread's table indexed by opcode, approximate while other
+  // threads are still counting; empty without OPCODE_STATS
+  std::vector<uint64_t> opcode_counts();
+
+  // histograms sorted by count, per class and per exact opcode
+  std::string opcode_report_text(const std::vector<uint64_t> &counts);
+  std::string opcode_report_json(const std::vector<uint64_t> &counts);
+
+  // writes the text report to stderr and the json one to `json_path`, on
+  // request and once more when it goes out of scope
+  class OpcodeReport {
+  public:
+    OpcodeReport(const std::optional<std::string> &json_path);
+    ~OpcodeReport();
+
+    void write() const;
+  private:
+    std::optional<std::string> json_path;
+  };
+}
+
+#endif // __OPCODE_STATS_HPP__
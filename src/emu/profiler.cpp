@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "opcode_stats.hpp"
+#include "profiler.hpp"
+#include "state.hpp"
+
+// rows listed per section of the text report
+static constexpr std::size_t report_rows = 32;
+
+emu::Profiler::Profiler() {
+  tree.push_back({root, 0, 0, {}});
+}
+
+uint64_t emu::Profiler::instructions() const {
+  return count;
+}
+
+void emu::Profiler::record(const qch_vm::machine &m) {
+  // blocked and halted cycles execute nothing
+  if (m.blocking || m.halted) {
+    return;
+  }
+
+  const uint16_t op = peek_opcode(m);
+
+  if (has_last && m.pc <= last_pc
+    && (last_op >> 12) != 0x2 && last_op != 0x00ee) {
+    back_edges[uint32_t(last_pc) << 16 | m.pc]++;
+  }
+  last_pc = m.pc;
+  last_op = op;
+  has_last = true;
+
+  pc_counts[m.pc & 0xfff]++;
+  count++;
+  tree[current].self++;
+
+  // calls are charged to the caller, returns to the subroutine
+  if ((op >> 12) == 0x2) {
+    call(op & 0xfff);
+  } else if (op == 0x00ee) {
+    ret();
+  }
+}
+
+void emu::Profiler::call(const uint16_t target) {
+  if (stack.size() >= max_depth) {
+    untracked++;
+    return;
+  }
+
+  subroutine &s = subroutines[target];
+  s.calls++;
+  s.active++;
+  stack.push_back({target, count});
+
+  const auto child = tree[current].children.find(target);
+  if (child != tree[current].children.end()) {
+    current = child->second;
+    return;
+  }
+
+  const std::size_t index = tree.size();
+  tree.push_back({target, current, 0, {}});
+  tree[current].children.emplace(target, index);
+  current = index;
+}
+
+void emu::Profiler::ret() {
+  if (untracked > 0) {
+    untracked--;
+    return;
+  }
+
+  // a return without a tracked call, e.g. from state loaded mid subroutine
+  if (stack.empty()) {
+    return;
+  }
+
+  const frame f = stack.back();
+  stack.pop_back();
+  subroutine &s = subroutines[f.function];
+  if (--s.active == 0) {
+    s.inclusive += count - f.entry;
+  }
+  current = tree[current].parent;
+}
+
+static std::string function_name(const uint16_t function) {
+  if (function == 0xffff) {
+    return "main";
+  }
+  char name[16];
+  std::snprintf(name, sizeof(name), "sub_%03x", function);
+  return name;
+}
+
+std::string emu::Profiler::report(const qch_vm::machine &m) const {
+  const double scale = count > 0 ? 100.0 / count : 0.0;
+  char line[128];
+  std::string out;
+
+  std::snprintf(
+    line, sizeof(line), "instructions: %llu\n",
+    static_cast<unsigned long long>(count)
+  );
+  out += line;
+
+  // hottest addresses
+  std::vector<uint16_t> pcs;
+  for (std::size_t pc = 0; pc < pc_counts.size(); pc++) {
+    if (pc_counts[pc] > 0) { pcs.push_back(pc); }
+  }
+  std::sort(pcs.begin(), pcs.end(), [&](const uint16_t a, const uint16_t b){
+    return pc_counts[a] != pc_counts[b] ? pc_counts[a] > pc_counts[b] : a < b;
+  });
+
+  out += "\nhot addresses:\n  addr  opcode class          count       %\n";
+  for (std::size_t i = 0; i < pcs.size() && i < report_rows; i++) {
+    const uint16_t pc = pcs[i];
+    const uint16_t op = (m.memory[pc] << 8) | m.memory[(pc + 1) & 0xfff];
+    std::snprintf(
+      line, sizeof(line), "  %03x   %04x   %-4s %14llu %6.2f%%\n", pc, op,
+      opcode_class(op).c_str(),
+      static_cast<unsigned long long>(pc_counts[pc]), pc_counts[pc] * scale
+    );
+    out += line;
+  }
+
+  // a loop spans its back-edge's target to its source; the body count is
+  // every instruction executed at addresses in that range
+  struct loop {
+    uint16_t header;
+    uint16_t latch;
+    uint64_t iterations;
+    uint64_t body;
+  };
+  std::vector<loop> loops;
+  for (const auto &[edge, n] : back_edges) {
+    const uint16_t from = (edge >> 16) & 0xfff;
+    const uint16_t to = edge & 0xfff;
+    uint64_t body = 0;
+    for (uint16_t pc = to; pc <= from; pc++) {
+      body += pc_counts[pc];
+    }
+    loops.push_back({to, from, n, body});
+  }
+  std::sort(loops.begin(), loops.end(), [](const loop &a, const loop &b){
+    return a.body != b.body ? a.body > b.body : a.header < b.header;
+  });
+
+  out += "\nloops:\n  header latch     iterations   instructions       %\n";
+  for (std::size_t i = 0; i < loops.size() && i < report_rows; i++) {
+    const loop &l = loops[i];
+    std::snprintf(
+      line, sizeof(line), "  %03x    %03x%s %14llu %14llu %6.2f%%\n",
+      l.header, l.latch, l.header == l.latch ? "*" : " ",
+      static_cast<unsigned long long>(l.iterations),
+      static_cast<unsigned long long>(l.body), l.body * scale
+    );
+    out += line;
+  }
+  out += "  (* jumps to itself)\n";
+
+  // exclusive counts come from the call tree, inclusive ones from closed
+  // calls plus the calls still open
+  std::map<uint16_t, uint64_t> exclusive;
+  for (const node &n : tree) {
+    exclusive[n.function] += n.self;
+  }
+  std::map<uint16_t, uint64_t> inclusive;
+  for (const auto &[function, s] : subroutines) {
+    inclusive[function] = s.inclusive;
+  }
+  std::map<uint16_t, std::size_t> open;
+  for (const frame &f : stack) {
+    if (open[f.function]++ == 0) {
+      inclusive[f.function] += count - f.entry;
+    }
+  }
+
+  std::vector<uint16_t> functions;
+  for (const auto &[function, s] : subroutines) {
+    functions.push_back(function);
+  }
+  std::sort(functions.begin(), functions.end(),
+    [&](const uint16_t a, const uint16_t b){
+      return inclusive[a] != inclusive[b] ? inclusive[a] > inclusive[b] : a < b;
+    });
+
+  out += "\nsubroutines:\n"
+    "  addr          calls      inclusive       %      exclusive       %\n";
+  for (std::size_t i = 0; i < functions.size() && i < report_rows; i++) {
+    const uint16_t f = functions[i];
+    std::snprintf(
+      line, sizeof(line), "  %03x  %14llu %14llu %6.2f%% %14llu %6.2f%%\n", f,
+      static_cast<unsigned long long>(subroutines.at(f).calls),
+      static_cast<unsigned long long>(inclusive[f]), inclusive[f] * scale,
+      static_cast<unsigned long long>(exclusive[f]), exclusive[f] * scale
+    );
+    out += line;
+  }
+  std::snprintf(
+    line, sizeof(line), "  main exclusive %llu\n",
+    static_cast<unsigned long long>(exclusive[root])
+  );
+  out += line;
+
+  return out;
+}
+
+std::string emu::Profiler::folded() const {
+  std::string out;
+
+  // depth first over the call tree, the path is the folded stack
+  std::vector<std::pair<std::size_t, std::string>> pending = {{0, "main"}};
+  while (!pending.empty()) {
+    const auto [index, path] = pending.back();
+    pending.pop_back();
+
+    const node &n = tree[index];
+    if (n.self > 0) {
+      out += path + " " + std::to_string(n.self) + "\n";
+    }
+    for (auto it = n.children.rbegin(); it != n.children.rend(); ++it) {
+      pending.push_back({it->second, path + ";" + function_name(it->first)});
+    }
+  }
+
+  return out;
+}
+
+bool emu::Profiler::write(
+  const std::string &prefix, const qch_vm::machine &m
+) const {
+  std::ofstream text(prefix + ".txt");
+  text << report(m);
+  std::ofstream stacks(prefix + ".folded");
+  stacks << folded();
+  return text.good() && stacks.good();
+}
@@ -0,0 +1,81 @@
+#ifndef __PROFILER_HPP__
+#define __PROFILER_HPP__
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+namespace emu {
+  // instruction counts per pc, attributed to loops and subroutines
+  //
+  // a shadow call stack follows 2NNN and 00EE; every instruction is counted
+  // against the current stack in a call tree, which gives exclusive counts
+  // per subroutine and folded stacks, while inclusive counts come from the
+  // instruction total between a call and its return. Any other transfer to
+  // the same or a lower address is a loop back-edge.
+  class Profiler {
+  public:
+    Profiler();
+
+    // call before every cycle, with the machine about to execute
+    void record(const qch_vm::machine &m);
+
+    uint64_t instructions() const;
+
+    // hottest addresses, loops and subroutines as text
+    std::string report(const qch_vm::machine &m) const;
+
+    // one "main;sub_0234;sub_0300 count" line per distinct call stack, the
+    // input format of flamegraph.pl and similar tools
+    std::string folded() const;
+
+    // report to <prefix>.txt and folded stacks to <prefix>.folded
+    bool write(const std::string &prefix, const qch_vm::machine &m) const;
+  private:
+    static constexpr uint16_t root = 0xffff; // outside any subroutine
+    static constexpr std::size_t max_depth = 64;
+
+    struct node {
+      uint16_t function;
+      std::size_t parent;
+      uint64_t self = 0;
+      std::map<uint16_t, std::size_t> children;
+    };
+
+    struct frame {
+      uint16_t function;
+      uint64_t entry; // instruction count at the call
+    };
+
+    struct subroutine {
+      uint64_t calls = 0;
+      uint64_t inclusive = 0;
+      std::size_t active = 0; // frames on the stack, for recursion
+    };
+
+    void call(const uint16_t target);
+    void ret();
+
+    std::array<uint64_t, 0x1000> pc_counts{};
+    uint64_t count = 0;
+
+    std::vector<node> tree;
+    std::size_t current = 0;
+    std::vector<frame> stack;
+    std::size_t untracked = 0; // open calls past max_depth
+    std::map<uint16_t, subroutine> subroutines;
+
+    // back-edges taken, keyed by from << 16 | to
+    std::unordered_map<uint32_t, uint64_t> back_edges;
+    uint16_t last_pc = 0;
+    uint16_t last_op = 0;
+    bool has_last = false;
+  };
+}
+
+#endif // __PROFILER_HPP__
@@ -0,0 +1,106 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "rewind.hpp"
+#include "snapshot.hpp"
+#include "state.hpp"
+
+emu::RewindBuffer::RewindBuffer(
+  const std::size_t capacity, const std::size_t max_frames
+) : ring(capacity), max_frames(max_frames)
+{
+  next.reserve(state_size());
+  encoded.reserve(state_size());
+}
+
+std::size_t emu::RewindBuffer::frames() const {
+  return records.size();
+}
+
+std::size_t emu::RewindBuffer::bytes() const {
+  return used;
+}
+
+void emu::RewindBuffer::clear() {
+  records.clear();
+  head.clear();
+  write_pos = 0;
+  used = 0;
+}
+
+std::size_t emu::RewindBuffer::place(const std::size_t size) {
+  auto drop_front = [this]{
+    used -= records.front().size;
+    records.pop_front();
+  };
+
+  // records between the write position and the end of the ring are the
+  // oldest, they go first when the new record has to wrap around
+  if (write_pos + size > ring.size()) {
+    while (!records.empty() && records.front().offset >= write_pos) {
+      drop_front();
+    }
+    write_pos = 0;
+  }
+
+  while (!records.empty() && records.front().offset >= write_pos
+    && records.front().offset < write_pos + size) {
+    drop_front();
+  }
+
+  const std::size_t offset = write_pos;
+  write_pos += size;
+  return offset;
+}
+
+void emu::RewindBuffer::push(const qch_vm::machine &m) {
+  const std::size_t size = state_size();
+  next.resize(size);
+  save_state(m, next.data());
+
+  if (head.size() != size) {
+    head.swap(next);
+    return;
+  }
+
+  encoded.clear();
+  encode_delta(next.data(), head.data(), size, encoded);
+
+  // a record that cannot fit would evict the whole history
+  if (encoded.size() <= ring.size() && max_frames > 0) {
+    while (records.size() >= max_frames) {
+      used -= records.front().size;
+      records.pop_front();
+    }
+
+    const std::size_t offset = place(encoded.size());
+    std::memcpy(ring.data() + offset, encoded.data(), encoded.size());
+    records.push_back({offset, encoded.size()});
+    used += encoded.size();
+  } else {
+    records.clear();
+    used = 0;
+  }
+
+  head.swap(next);
+}
+
+bool emu::RewindBuffer::pop(qch_vm::machine &m) {
+  if (records.empty()) {
+    return false;
+  }
+
+  const record r = records.back();
+  records.pop_back();
+  used -= r.size;
+  write_pos = r.offset;
+
+  apply_delta(head.data(), head.size(), ring.data() + r.offset, r.size);
+
+  restore_state(m, head.data());
+  return true;
+}
@@ -0,0 +1,54 @@
+#ifndef __REWIND_HPP__
+#define __REWIND_HPP__
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+namespace emu {
+  // frame history in a fixed size byte ring
+  //
+  // each push stores the xor delta that turns the new state back into the
+  // previous one, so stepping backwards is one delta per frame starting
+  // from the full state of the most recent frame. The oldest frames are
+  // dropped when the ring or `max_frames` is full; no full states are
+  // stored, since reconstruction never starts from the old end.
+  class RewindBuffer {
+  public:
+    RewindBuffer(const std::size_t capacity, const std::size_t max_frames);
+
+    // records one emulated frame
+    void push(const qch_vm::machine &m);
+
+    // restores the frame before the most recently pushed one, which then
+    // becomes the most recent; false when no history is left
+    bool pop(qch_vm::machine &m);
+
+    void clear();
+
+    std::size_t frames() const;
+    std::size_t bytes() const;
+  private:
+    struct record {
+      std::size_t offset;
+      std::size_t size;
+    };
+
+    // reserves `size` contiguous bytes, dropping the oldest records
+    std::size_t place(const std::size_t size);
+
+    std::vector<uint8_t> ring;
+    std::size_t max_frames;
+    std::deque<record> records;
+    std::size_t write_pos = 0;
+    std::size_t used = 0;
+
+    std::vector<uint8_t> head; // state of the most recent frame
+    std::vector<uint8_t> next;
+    std::vector<uint8_t> encoded;
+  };
+}
+
+#endif // __REWIND_HPP__
@@ -0,0 +1,42 @@
+#include <cstddef>
+#include <cstdint>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "cycle.hpp"
+#include "opcode_stats.hpp"
+#include "run_ahead.hpp"
+#include "state.hpp"
+#include "trace.hpp"
+
+emu::RunAhead::RunAhead(const std::size_t frames) : frames(frames) {}
+
+const qch_vm::machine &emu::RunAhead::machine() const {
+  return ahead;
+}
+
+bool emu::RunAhead::run(const qch_vm::machine &m, const virtual_clock &clock) {
+  copy_state(ahead, m);
+  virtual_clock ahead_clock = clock;
+  const uint64_t random = random_state();
+
+  // speculative frames are left out of any trace and the opcode counts
+  TraceRing *const trace = tracing();
+  trace_to(nullptr);
+  const bool counting = counting_opcodes();
+  count_opcodes(false);
+
+  const uint64_t target = clock.frames + frames;
+  while (ahead_clock.frames < target && !ahead.quit) {
+    step(ahead, ahead_clock);
+  }
+
+  trace_to(trace);
+  count_opcodes(counting);
+  seed_random(random);
+
+  const uint64_t h = gfx_hash(ahead);
+  const bool changed = h != shown;
+  shown = h;
+  return changed;
+}
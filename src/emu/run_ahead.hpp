@@ -0,0 +1,33 @@
+#ifndef __RUN_AHEAD_HPP__
+#define __RUN_AHEAD_HPP__
+#include <cstddef>
+#include <cstdint>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "cycle.hpp"
+
+namespace emu {
+  // the machine as it will be `frames` 60hz frames from now if the keys stay
+  // as they are, shown in place of the real one to hide that many frames of
+  // input latency
+  //
+  // the state is copied into a scratch machine that runs ahead and is thrown
+  // away, so the real machine is never rolled back; only the random source
+  // is put back afterwards
+  class RunAhead {
+  public:
+    RunAhead(const std::size_t frames);
+
+    // returns true when the future framebuffer differs from the previous run
+    bool run(const qch_vm::machine &m, const virtual_clock &clock);
+
+    const qch_vm::machine &machine() const;
+  private:
+    std::size_t frames;
+    qch_vm::machine ahead;
+    uint64_t shown = 0;
+  };
+}
+
+#endif // __RUN_AHEAD_HPP__
@@ -0,0 +1,74 @@
+#include <cstdint>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../util/timer.hpp"
+#include "cycle.hpp"
+#include "input_script.hpp"
+#include "runner.hpp"
+#include "state.hpp"
+
+// a repeated state is only looked for every ten emulated seconds, hashing
+// the machine is expensive compared to a cycle
+static constexpr uint64_t progress_interval = emu::timer_frequency * 10;
+static constexpr uint64_t wall_check_interval = 64;
+
+const char *emu::to_string(const run_status_t status) {
+  switch (status) {
+    case run_status_t::quit: return "quit";
+    case run_status_t::halted: return "halted";
+    case run_status_t::idle: return "idle";
+    case run_status_t::waiting: return "waiting";
+    case run_status_t::budget: return "budget";
+    case run_status_t::timeout: return "timeout";
+  }
+
+  return "unknown";
+}
+
+emu::run_result emu::run(
+  qch_vm::machine &m, const run_limits &limits, const input_script *script
+) {
+  run_result result;
+  InputPlayer input(script);
+  timing::Clock wall_clock;
+  uint64_t last_progress = 0;
+
+  auto finish = [&](const run_status_t status) {
+    result.status = status;
+    result.seconds = wall_clock.get().count();
+    return result;
+  };
+
+  while (result.clock.cycles < limits.cycles) {
+    input.apply(result.clock.cycles, m);
+    if (!emu::step(m, result.clock)) { continue; }
+
+    // frame boundary
+    result.frames++;
+
+    if (m.quit) { return finish(run_status_t::quit); }
+    if (m.halted) { return finish(run_status_t::halted); }
+
+    if (input.finished()) {
+      if (m.blocking) { return finish(run_status_t::waiting); }
+      if (is_self_jump(m)) { return finish(run_status_t::idle); }
+
+      if (result.frames % progress_interval == 0) {
+        const uint64_t progress = progress_hash(m);
+        if (progress == last_progress) {
+          return finish(run_status_t::idle);
+        }
+        last_progress = progress;
+      }
+    }
+
+    if (limits.wall.count() > 0.0
+      && result.frames % wall_check_interval == 0
+      && wall_clock.get() >= limits.wall) {
+      return finish(run_status_t::timeout);
+    }
+  }
+
+  return finish(run_status_t::budget);
+}
@@ -0,0 +1,43 @@
+#ifndef __RUNNER_HPP__
+#define __RUNNER_HPP__
+#include <cstdint>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../util/timer.hpp"
+#include "cycle.hpp"
+#include "input_script.hpp"
+
+namespace emu {
+  enum class run_status_t {
+    quit,    // the program exited
+    halted,  // the machine halted
+    idle,    // stuck in a loop that no longer changes any state
+    waiting, // waiting for a key with no scripted input left
+    budget,  // still running when the cycle budget ran out
+    timeout  // the wall clock limit was hit first
+  };
+
+  const char *to_string(const run_status_t status);
+
+  struct run_limits {
+    uint64_t cycles = 0;
+    timing::seconds wall{0.0}; // zero for no limit
+  };
+
+  struct run_result {
+    run_status_t status = run_status_t::budget;
+    virtual_clock clock;
+    uint64_t frames = 0;
+    double seconds = 0.0;
+  };
+
+  // runs unthrottled on emulated time until the program stops making
+  // progress or a limit is reached
+  run_result run(
+    qch_vm::machine &m, const run_limits &limits,
+    const input_script *script=nullptr
+  );
+}
+
+#endif // __RUNNER_HPP__
@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "cycle.hpp"
+#include "input_script.hpp"
+#include "seek.hpp"
+#include "snapshot.hpp"
+#include "state.hpp"
+
+emu::Seeker::Seeker(
+  const qch_vm::machine &start, const input_script *script,
+  const uint64_t seed, const std::size_t interval
+) : script(script), interval(std::max<std::size_t>(interval, 1))
+{
+  zero.assign(state_size(), 0);
+  scratch.resize(state_size());
+
+  // the run starts from a freshly seeded source
+  seed_random(seed);
+  keep(start, {});
+}
+
+std::size_t emu::Seeker::keyframes() const {
+  return keys.size();
+}
+
+std::size_t emu::Seeker::bytes() const {
+  return stored;
+}
+
+void emu::Seeker::keep(const qch_vm::machine &m, const virtual_clock &clock) {
+  save_state(m, scratch.data());
+
+  keyframe k{clock, random_state(), {}};
+  encode_delta(zero.data(), scratch.data(), scratch.size(), k.state);
+  k.state.shrink_to_fit();
+  stored += k.state.size();
+  keys.push_back(std::move(k));
+}
+
+void emu::Seeker::observe(
+  const qch_vm::machine &m, const virtual_clock &clock
+) {
+  if (clock.frames % interval == 0 && clock.frames / interval == keys.size()) {
+    keep(m, clock);
+  }
+}
+
+bool emu::Seeker::seek(
+  const uint64_t frame, qch_vm::machine &m, virtual_clock &clock,
+  InputPlayer &player
+) {
+  const keyframe &k = keys[
+    std::min<std::size_t>(frame / interval, keys.size() - 1)
+  ];
+
+  std::fill(scratch.begin(), scratch.end(), 0);
+  apply_delta(scratch.data(), scratch.size(), k.state.data(), k.state.size());
+  restore_state(m, scratch.data());
+  clock = k.clock;
+  seed_random(k.random);
+  player = InputPlayer(script);
+  player.seek(clock.cycles);
+
+  // same order as an interactive or headless run: input, then the slot
+  while (clock.frames < frame) {
+    if (m.quit) {
+      return false;
+    }
+    player.apply(clock.cycles, m);
+    if (step(m, clock)) {
+      observe(m, clock);
+    }
+  }
+
+  return true;
+}
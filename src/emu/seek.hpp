@@ -0,0 +1,61 @@
+#ifndef __SEEK_HPP__
+#define __SEEK_HPP__
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "cycle.hpp"
+#include "input_script.hpp"
+
+namespace emu {
+  // random access to any frame of a deterministic run
+  //
+  // a run is a start state, a seed and scripted input. Every `interval`
+  // frames the full state (run length encoded against zero), clock and
+  // random source are kept as a keyframe; seeking restores the closest
+  // keyframe at or before the target and replays the script headless from
+  // there. Keyframes are made on the way when a seek or the owner's own run
+  // gets past the last one, so nothing is precomputed.
+  class Seeker {
+  public:
+    Seeker(
+      const qch_vm::machine &start, const input_script *script,
+      const uint64_t seed, const std::size_t interval=300
+    );
+
+    // keeps a keyframe when `clock` just reached one, for runs of the same
+    // script driven by the caller; call after every step that ends a frame
+    void observe(const qch_vm::machine &m, const virtual_clock &clock);
+
+    // puts `m`, `clock`, `player` and the random source at the start of
+    // `frame`; false when the program quits before it, `m` is then left at
+    // the quit
+    bool seek(
+      const uint64_t frame, qch_vm::machine &m, virtual_clock &clock,
+      InputPlayer &player
+    );
+
+    std::size_t keyframes() const;
+    std::size_t bytes() const;
+  private:
+    struct keyframe {
+      virtual_clock clock;
+      uint64_t random;
+      std::vector<uint8_t> state;
+    };
+
+    void keep(const qch_vm::machine &m, const virtual_clock &clock);
+
+    const input_script *script;
+    std::size_t interval;
+    std::vector<keyframe> keys; // keys[k] is frame k * interval
+    std::size_t stored = 0;
+
+    std::vector<uint8_t> zero;
+    std::vector<uint8_t> scratch;
+  };
+}
+
+#endif // __SEEK_HPP__
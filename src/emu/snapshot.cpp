@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "snapshot.hpp"
+#include "state.hpp"
+
+static const char magic[4] = {'Q', 'C', 'H', 'S'};
+static constexpr std::size_t header_size = 4 + 2 + 4 + 8;
+static constexpr std::size_t record_header_size = 1 + 4;
+static constexpr uint8_t record_full = 'F';
+static constexpr uint8_t record_delta = 'D';
+
+// a delta bigger than this fraction of the state starts a new base
+static constexpr std::size_t rebase_divisor = 4;
+
+static void put_le(std::vector<uint8_t> &out, uint64_t v, const std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    out.push_back(v & 0xff);
+    v >>= 8;
+  }
+}
+
+static uint64_t get_le(const uint8_t *in, const std::size_t n) {
+  uint64_t v = 0;
+  for (std::size_t i = n; i-- > 0;) {
+    v = (v << 8) | in[i];
+  }
+  return v;
+}
+
+static void put_varint(std::vector<uint8_t> &out, std::size_t v) {
+  while (v >= 0x80) {
+    out.push_back((v & 0x7f) | 0x80);
+    v >>= 7;
+  }
+  out.push_back(v);
+}
+
+static bool get_varint(
+  const uint8_t *&in, const uint8_t *end, std::size_t &v
+) {
+  v = 0;
+  for (std::size_t shift = 0; in < end && shift < 64; shift += 7) {
+    const uint8_t b = *in++;
+    v |= static_cast<std::size_t>(b & 0x7f) << shift;
+    if (!(b & 0x80)) { return true; }
+  }
+  return false;
+}
+
+void emu::encode_delta(
+  const uint8_t *base, const uint8_t *next, const std::size_t size,
+  std::vector<uint8_t> &out
+) {
+  std::size_t i = 0;
+  while (i < size) {
+    const std::size_t run_start = i;
+    while (i < size && base[i] == next[i]) { i++; }
+    if (i == size) { break; }
+
+    // a literal ends at the first pair of equal bytes, so single matching
+    // bytes inside a changed region do not cost a new triple
+    const std::size_t literal_start = i;
+    while (i < size && (base[i] != next[i]
+      || (i + 1 < size && base[i + 1] != next[i + 1]))) {
+      i++;
+    }
+
+    put_varint(out, literal_start - run_start);
+    put_varint(out, i - literal_start);
+    for (std::size_t j = literal_start; j < i; j++) {
+      out.push_back(base[j] ^ next[j]);
+    }
+  }
+}
+
+bool emu::apply_delta(
+  uint8_t *state, const std::size_t size, const uint8_t *delta,
+  const std::size_t delta_size
+) {
+  const uint8_t *in = delta;
+  const uint8_t *end = delta + delta_size;
+  std::size_t pos = 0;
+
+  while (in < end) {
+    std::size_t skip, length;
+    if (!get_varint(in, end, skip) || !get_varint(in, end, length)) {
+      return false;
+    }
+    if (skip > size - pos || length > size - pos - skip
+      || length > static_cast<std::size_t>(end - in)) {
+      return false;
+    }
+
+    pos += skip;
+    for (std::size_t j = 0; j < length; j++) {
+      state[pos++] ^= *in++;
+    }
+  }
+
+  return true;
+}
+
+emu::SaveStates::SaveStates(const std::string &path, const uint64_t program_hash)
+  : path(path), program_hash(program_hash)
+{
+  read_file();
+  writer = std::thread(&SaveStates::run, this);
+}
+
+emu::SaveStates::~SaveStates() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  ready.notify_one();
+  writer.join();
+}
+
+std::size_t emu::SaveStates::count() const {
+  return saves;
+}
+
+void emu::SaveStates::read_file() {
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs) { return; }
+
+  const std::vector<uint8_t> data(
+    (std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>()
+  );
+  const std::size_t size = state_size();
+
+  if (data.size() < header_size
+    || !std::equal(std::begin(magic), std::end(magic), data.begin())
+    || get_le(&data[4], 2) != snapshot_version
+    || get_le(&data[6], 4) != size
+    || get_le(&data[10], 8) != program_hash) {
+    return;
+  }
+
+  // a truncated or corrupt tail keeps the states read before it
+  std::size_t pos = header_size;
+  bool intact = true;
+  while (pos < data.size()) {
+    if (data.size() - pos < record_header_size) { intact = false; break; }
+    const uint8_t type = data[pos];
+    const std::size_t length = get_le(&data[pos + 1], 4);
+    const uint8_t *payload = &data[pos + record_header_size];
+    if (data.size() - pos - record_header_size < length) {
+      intact = false;
+      break;
+    }
+
+    if (type == record_full && length == size) {
+      base.assign(payload, payload + length);
+      latest = base;
+    } else if (type == record_delta && base.size() == size) {
+      std::vector<uint8_t> next = base;
+      if (!apply_delta(next.data(), size, payload, length)) {
+        intact = false;
+        break;
+      }
+      latest = std::move(next);
+    } else {
+      intact = false;
+      break;
+    }
+
+    saves++;
+    pos += record_header_size + length;
+  }
+
+  fresh = !intact;
+}
+
+void emu::SaveStates::save(const qch_vm::machine &m) {
+  const std::size_t size = state_size();
+  scratch.resize(size);
+  save_state(m, scratch.data());
+
+  std::vector<uint8_t> chunk;
+  if (fresh) {
+    chunk.insert(chunk.end(), std::begin(magic), std::end(magic));
+    put_le(chunk, snapshot_version, 2);
+    put_le(chunk, size, 4);
+    put_le(chunk, program_hash, 8);
+  }
+
+  std::vector<uint8_t> delta;
+  if (!fresh && base.size() == size) {
+    encode_delta(base.data(), scratch.data(), size, delta);
+  }
+
+  if (fresh || base.size() != size || delta.size() > size / rebase_divisor) {
+    base = scratch;
+    chunk.push_back(record_full);
+    put_le(chunk, size, 4);
+    chunk.insert(chunk.end(), base.begin(), base.end());
+  } else {
+    chunk.push_back(record_delta);
+    put_le(chunk, delta.size(), 4);
+    chunk.insert(chunk.end(), delta.begin(), delta.end());
+  }
+
+  write(std::move(chunk));
+  latest = scratch;
+  fresh = false;
+  saves++;
+}
+
+bool emu::SaveStates::load(qch_vm::machine &m) const {
+  if (latest.size() != state_size()) {
+    return false;
+  }
+
+  restore_state(m, latest.data());
+  return true;
+}
+
+void emu::SaveStates::write(std::vector<uint8_t> chunk) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(std::move(chunk));
+  }
+  ready.notify_one();
+}
+
+void emu::SaveStates::run() {
+  std::ofstream ofs;
+  std::vector<std::vector<uint8_t>> batch;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      ready.wait(lock, [this]{ return stopping || !pending.empty(); });
+      if (pending.empty()) { return; }
+      batch.swap(pending);
+    }
+
+    for (const auto &chunk : batch) {
+      // a chunk that starts with the header replaces the file
+      const bool header = chunk.size() >= header_size
+        && std::equal(std::begin(magic), std::end(magic), chunk.begin());
+      if (header || !ofs.is_open()) {
+        ofs.close();
+        ofs.open(path, std::ios::binary | (header ? std::ios::trunc : std::ios::app));
+      }
+
+      ofs.write(reinterpret_cast<const char *>(chunk.data()), chunk.size());
+      ofs.flush();
+    }
+    batch.clear();
+  }
+}
@@ -0,0 +1,75 @@
+#ifndef __SNAPSHOT_HPP__
+#define __SNAPSHOT_HPP__
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+namespace emu {
+  static constexpr uint16_t snapshot_version = 1;
+
+  // xor of `next` against `base` as (zero run, literal length, literal xor
+  // bytes) triples with varint lengths, appended to `out`
+  void encode_delta(
+    const uint8_t *base, const uint8_t *next, const std::size_t size,
+    std::vector<uint8_t> &out
+  );
+
+  // applies an encode_delta result to `state` in place, returns false when
+  // the delta is malformed or runs past `size`
+  bool apply_delta(
+    uint8_t *state, const std::size_t size, const uint8_t *delta,
+    const std::size_t delta_size
+  );
+
+  // save states of one program, kept in memory and appended to a file
+  //
+  // file: "QCHS", u16 version, u32 state size, u64 program hash (little
+  // endian), then records of u8 type, u32 payload size and payload, where
+  // type 'F' holds a full state that becomes the base and 'D' a delta
+  // against the latest base
+  class SaveStates {
+  public:
+    // reads an existing file when it matches the version, state size and
+    // program, otherwise the first save replaces it
+    SaveStates(const std::string &path, const uint64_t program_hash);
+    ~SaveStates();
+
+    SaveStates(const SaveStates &) = delete;
+    SaveStates &operator=(const SaveStates &) = delete;
+
+    // encodes the state on the calling thread, the file is written from a
+    // background thread
+    void save(const qch_vm::machine &m);
+
+    // restores the most recent state, false when there is none
+    bool load(qch_vm::machine &m) const;
+
+    std::size_t count() const;
+  private:
+    void read_file();
+    void write(std::vector<uint8_t> chunk);
+    void run();
+
+    std::string path;
+    uint64_t program_hash;
+    std::vector<uint8_t> base;
+    std::vector<uint8_t> latest;
+    std::vector<uint8_t> scratch;
+    std::size_t saves = 0;
+    bool fresh = true; // file has to be rewritten from the header
+
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::vector<std::vector<uint8_t>> pending;
+    bool stopping = false;
+  };
+}
+
+#endif // __SNAPSHOT_HPP__
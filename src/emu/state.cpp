@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "state.hpp"
+
+// calls `f` on every field that makes up the machine state
+template <typename M, typename F>
+static void for_each_field(M &m, F &&f) {
+  f(m.memory);
+  f(m.V);
+  f(m.I);
+  f(m.pc);
+  f(m.stack);
+  f(m.sp);
+  f(m.delay_timer);
+  f(m.sound_timer);
+  f(m.keys);
+  f(m.gfx);
+  f(m.draw);
+  f(m.blocking);
+  f(m.halted);
+  f(m.quit);
+}
+
+template <typename T>
+static uint64_t hash_value(const T &v, const uint64_t h) {
+  return emu::hash_bytes(&v, sizeof(v), h);
+}
+
+uint64_t emu::hash_bytes(const void *data, const std::size_t size, uint64_t h) {
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  for (std::size_t i = 0; i < size; i++) {
+    h ^= bytes[i];
+    h *= 0x100000001b3;
+  }
+
+  return h;
+}
+
+std::string emu::hash_string(const uint64_t h) {
+  char buf[17];
+  std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(h));
+  return buf;
+}
+
+uint64_t emu::state_hash(const qch_vm::machine &m) {
+  uint64_t h = progress_hash(m);
+  h = hash_value(m.delay_timer, h);
+  h = hash_value(m.sound_timer, h);
+
+  return h;
+}
+
+uint64_t emu::progress_hash(const qch_vm::machine &m) {
+  uint64_t h = hash_seed;
+  h = hash_value(m.V, h);
+  h = hash_value(m.I, h);
+  h = hash_value(m.pc, h);
+  h = hash_value(m.stack, h);
+  h = hash_value(m.sp, h);
+  h = hash_value(m.memory, h);
+  h = hash_value(m.gfx, h);
+
+  return h;
+}
+
+uint16_t emu::peek_opcode(const qch_vm::machine &m) {
+  const std::size_t mask = m.memory.size() - 1;
+  return (m.memory[m.pc & mask] << 8) | m.memory[(m.pc + 1) & mask];
+}
+
+bool emu::is_self_jump(const qch_vm::machine &m) {
+  const uint16_t op = peek_opcode(m);
+  return (op & 0xf000) == 0x1000 && (op & 0x0fff) == (m.pc & 0x0fff);
+}
+
+uint64_t emu::gfx_hash(const qch_vm::machine &m) {
+  return hash_value(m.gfx, hash_seed);
+}
+
+void emu::write_program(
+  qch_vm::machine &m, const std::vector<uint8_t> &program
+) {
+  const std::size_t size = std::min(
+    program.size(), m.memory.size() - program_start
+  );
+  std::copy_n(program.begin(), size, m.memory.begin() + program_start);
+}
+
+void emu::execute_random(
+  qch_vm::machine &m, const uint16_t op, const uint8_t value
+) {
+  m.V[(op >> 8) & 0xf] = value & (op & 0xff);
+  m.pc += 2;
+}
+
+uint16_t emu::key_mask(const qch_vm::machine &m) {
+  uint16_t mask = 0;
+  for (std::size_t k = 0; k < 16; k++) {
+    mask |= m.keys[k] ? (1 << k) : 0;
+  }
+  return mask;
+}
+
+void emu::set_key_mask(qch_vm::machine &m, const uint16_t mask) {
+  for (std::size_t k = 0; k < 16; k++) {
+    m.keys[k] = (mask >> k) & 1;
+  }
+}
+
+std::size_t emu::state_size() {
+  static const std::size_t size = [](){
+    const qch_vm::machine m;
+    std::size_t n = 0;
+    for_each_field(m, [&](const auto &f){ n += sizeof(f); });
+    return n;
+  }();
+
+  return size;
+}
+
+std::vector<std::size_t> emu::state_field_sizes() {
+  const qch_vm::machine m;
+  std::vector<std::size_t> sizes;
+  for_each_field(m, [&](const auto &f){ sizes.push_back(sizeof(f)); });
+  return sizes;
+}
+
+void emu::save_state(const qch_vm::machine &m, uint8_t *out) {
+  for_each_field(m, [&](const auto &f){
+    std::memcpy(out, &f, sizeof(f));
+    out += sizeof(f);
+  });
+}
+
+void emu::restore_state(qch_vm::machine &m, const uint8_t *in) {
+  for_each_field(m, [&](auto &f){
+    std::memcpy(&f, in, sizeof(f));
+    in += sizeof(f);
+  });
+}
+
+void emu::copy_state(qch_vm::machine &to, const qch_vm::machine &from) {
+  // each field of `from` sits at the same offset as the one in `to`
+  const char *base = reinterpret_cast<const char *>(&from);
+  for_each_field(to, [&](auto &f){
+    const std::ptrdiff_t offset = reinterpret_cast<const char *>(&f)
+      - reinterpret_cast<const char *>(&to);
+    std::memcpy(&f, base + offset, sizeof(f));
+  });
+}
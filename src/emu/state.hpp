@@ -0,0 +1,62 @@
+#ifndef __STATE_HPP__
+#define __STATE_HPP__
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+namespace emu {
+  // address programs are loaded at
+  static constexpr uint16_t program_start = 0x200;
+
+  // 64 bit fnv-1a
+  static constexpr uint64_t hash_seed = 0xcbf29ce484222325;
+  uint64_t hash_bytes(const void *data, const std::size_t size, uint64_t h=hash_seed);
+
+  // hash of registers, stack, timers, memory and framebuffer
+  uint64_t state_hash(const qch_vm::machine &m);
+
+  // zero padded lower case hex
+  std::string hash_string(const uint64_t h);
+
+  // hash of the framebuffer only
+  uint64_t gfx_hash(const qch_vm::machine &m);
+
+  // state_hash without the timers, unchanged while a program only idles
+  uint64_t progress_hash(const qch_vm::machine &m);
+
+  // opcode at the program counter
+  uint16_t peek_opcode(const qch_vm::machine &m);
+
+  // true when the next instruction is a jump to itself (1NNN with NNN == pc)
+  bool is_self_jump(const qch_vm::machine &m);
+
+  // CXNN with `value` as the random byte
+  void execute_random(qch_vm::machine &m, const uint16_t op, const uint8_t value);
+
+  // keypad as a bit mask, bit k = key k
+  uint16_t key_mask(const qch_vm::machine &m);
+  void set_key_mask(qch_vm::machine &m, const uint16_t mask);
+
+  // size of the raw machine state written by save_state: memory, registers,
+  // stack, timers, keys, framebuffer and the draw/blocking/halted/quit flags
+  std::size_t state_size();
+
+  // size of each field in save_state order
+  std::vector<std::size_t> state_field_sizes();
+
+  // fields are copied in a fixed order in host byte order
+  void save_state(const qch_vm::machine &m, uint8_t *out);
+  void restore_state(qch_vm::machine &m, const uint8_t *in);
+
+  // save_state straight into another machine, without the intermediate buffer
+  void copy_state(qch_vm::machine &to, const qch_vm::machine &from);
+
+  // copies `program` to program_start, truncated to the end of memory,
+  // without touching the rest of the machine
+  void write_program(qch_vm::machine &m, const std::vector<uint8_t> &program);
+}
+
+#endif // __STATE_HPP__
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "opcode_stats.hpp"
+#include "trace.hpp"
+
+static constexpr std::array<char, 4> trace_magic = {'Q', 'C', 'T', 'R'};
+
+static std::size_t ring_size(const std::size_t capacity) {
+  std::size_t size = 1;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  return size;
+}
+
+emu::TraceRing::TraceRing(const std::size_t capacity)
+  : ring(ring_size(capacity)), mask(ring.size() - 1) {}
+
+uint64_t emu::TraceRing::total() const {
+  return head;
+}
+
+std::vector<emu::trace_record> emu::TraceRing::records() const {
+  const uint64_t count = std::min<uint64_t>(head, ring.size());
+  std::vector<trace_record> out;
+  out.reserve(count);
+  for (uint64_t n = head - count; n < head; n++) {
+    out.push_back(ring[n & mask]);
+  }
+  return out;
+}
+
+bool emu::TraceRing::write(const std::string &path) const {
+  const std::vector<trace_record> stored = records();
+  const trace_header header = {
+    trace_magic, trace_version, sizeof(trace_record), 0, head, stored.size()
+  };
+
+  std::ofstream ofs(path, std::ios::binary);
+  ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  ofs.write(
+    reinterpret_cast<const char *>(stored.data()),
+    stored.size() * sizeof(trace_record)
+  );
+  return ofs.good();
+}
+
+std::optional<std::vector<emu::trace_record>> emu::read_trace(
+  const std::string &path, trace_header &header
+) {
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs.read(reinterpret_cast<char *>(&header), sizeof(header))
+    || header.magic != trace_magic || header.version != trace_version
+    || header.record_size != sizeof(trace_record)) {
+    return {};
+  }
+
+  // a corrupt count must not allocate more than the file can hold
+  const std::streamoff start = ifs.tellg();
+  ifs.seekg(0, std::ios::end);
+  const std::streamoff end = ifs.tellg();
+  ifs.seekg(start);
+  if (start < 0 || end < start
+    || header.count > uint64_t(end - start) / sizeof(trace_record)) {
+    return {};
+  }
+
+  std::vector<trace_record> records(header.count);
+  if (!ifs.read(
+    reinterpret_cast<char *>(records.data()),
+    records.size() * sizeof(trace_record)
+  )) {
+    return {};
+  }
+
+  return records;
+}
+
+std::string emu::trace_text(const std::vector<trace_record> &records) {
+  char field[32];
+  std::string out;
+
+  for (std::size_t n = 0; n < records.size(); n++) {
+    const trace_record &r = records[n];
+    std::snprintf(
+      field, sizeof(field), "%12llu  %03x  %04x  %-4s",
+      static_cast<unsigned long long>(r.cycle), r.pc, r.opcode,
+      opcode_class(r.opcode).c_str()
+    );
+    out += field;
+
+    for (std::size_t v = 0; v < r.v.size(); v++) {
+      if (r.changed & (1 << v)) {
+        std::snprintf(field, sizeof(field), "  V%X=%02x", unsigned(v), r.v[v]);
+        out += field;
+      }
+    }
+
+    // the first record has nothing to compare I with
+    if (n == 0 || records[n - 1].i != r.i) {
+      std::snprintf(field, sizeof(field), "  I=%03x", r.i);
+      out += field;
+    }
+    out += "\n";
+  }
+
+  return out;
+}
@@ -0,0 +1,93 @@
+#ifndef __TRACE_HPP__
+#define __TRACE_HPP__
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "state.hpp"
+
+namespace emu {
+  // one executed instruction, stored as is in the ring and in trace files
+  struct trace_record {
+    uint64_t cycle;
+    uint16_t pc;
+    uint16_t opcode;
+    uint16_t changed; // bit n set when Vn changed
+    uint16_t i;       // I after the instruction
+    std::array<uint8_t, 16> v; // registers after the instruction
+  };
+  static_assert(sizeof(trace_record) == 32, "trace records are 32 bytes");
+
+  // trace file header, followed by `count` records oldest first
+  struct trace_header {
+    std::array<char, 4> magic; // "QCTR"
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t reserved;
+    uint64_t total; // instructions traced, the file keeps the last `count`
+    uint64_t count;
+  };
+
+  static constexpr uint32_t trace_version = 1;
+
+  // the last `capacity` instructions executed by emu::step, rounded up to a
+  // power of two; all memory is allocated up front, so tracing costs a
+  // register copy and compare per instruction
+  class TraceRing {
+  public:
+    TraceRing(const std::size_t capacity);
+
+    // fills the next slot from the machine about to execute
+    void begin(const qch_vm::machine &m, const uint64_t cycle) {
+      trace_record &r = ring[head & mask];
+      r.cycle = cycle;
+      r.pc = m.pc;
+      r.opcode = peek_opcode(m);
+      r.v = m.V;
+    }
+
+    // completes the slot once the instruction ran, cycles that executed
+    // nothing never commit theirs
+    void commit(const qch_vm::machine &m) {
+      trace_record &r = ring[head & mask];
+      uint16_t changed = 0;
+      for (std::size_t n = 0; n < r.v.size(); n++) {
+        changed |= uint16_t(r.v[n] != m.V[n]) << n;
+      }
+      r.changed = changed;
+      r.i = m.I;
+      r.v = m.V;
+      head++;
+    }
+
+    uint64_t total() const;
+
+    // stored records, oldest first
+    std::vector<trace_record> records() const;
+
+    bool write(const std::string &path) const;
+  private:
+    std::vector<trace_record> ring;
+    std::size_t mask;
+    uint64_t head = 0;
+  };
+
+  // traces emu::step on this thread into `ring`, nullptr stops tracing
+  void trace_to(TraceRing *ring);
+  TraceRing *tracing();
+
+  // records of a trace file, or nothing when it is missing or malformed
+  std::optional<std::vector<trace_record>> read_trace(
+    const std::string &path, trace_header &header
+  );
+
+  // one line per record with the registers it changed
+  std::string trace_text(const std::vector<trace_record> &records);
+}
+
+#endif // __TRACE_HPP__
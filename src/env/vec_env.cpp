@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../emu/cycle.hpp"
+#include "../emu/state.hpp"
+#include "../util/thread_pool.hpp"
+#include "vec_env.hpp"
+
+env::VecEnv::VecEnv(const config_t &config)
+  : config(config),
+    machines(std::max<std::size_t>(config.envs, 1)),
+    clocks(machines.size()),
+    random(machines.size()),
+    pool(std::min(config.threads, machines.size()))
+{
+  this->config.envs = machines.size();
+  this->config.frame_skip = std::max<std::size_t>(config.frame_skip, 1);
+  qch_vm::load_program(initial, config.program);
+  obs_size = initial.display_width * initial.display_height;
+
+  obs.resize(machines.size() * obs_size);
+  reward.resize(machines.size());
+  done.resize(machines.size());
+
+  // one range per thread, no more tasks than threads
+  chunk = (machines.size() + pool.size() - 1) / pool.size();
+
+  reset();
+}
+
+std::size_t env::VecEnv::size() const {
+  return machines.size();
+}
+
+std::size_t env::VecEnv::observation_size() const {
+  return obs_size;
+}
+
+const uint8_t *env::VecEnv::observations() const {
+  return obs.data();
+}
+
+const float *env::VecEnv::rewards() const {
+  return reward.data();
+}
+
+const uint8_t *env::VecEnv::dones() const {
+  return done.data();
+}
+
+uint64_t env::VecEnv::frames(const std::size_t env) const {
+  return clocks[env].frames;
+}
+
+const qch_vm::machine &env::VecEnv::machine(const std::size_t env) const {
+  return machines[env];
+}
+
+void env::VecEnv::reset_env(const std::size_t env) {
+  emu::copy_state(machines[env], initial);
+  clocks[env] = {};
+
+  // seed_random maps zero to a fixed non zero state
+  emu::seed_random(config.seed + env);
+  random[env] = emu::random_state();
+}
+
+void env::VecEnv::observe(const std::size_t env) {
+  const qch_vm::machine &m = machines[env];
+  uint8_t *out = obs.data() + env * obs_size;
+  for (std::size_t i = 0; i < obs_size; i++) {
+    out[i] = m.gfx[i] ? 1 : 0;
+  }
+}
+
+void env::VecEnv::reset() {
+  for (std::size_t e = 0; e < machines.size(); e++) {
+    reset_env(e);
+    observe(e);
+  }
+  std::fill(reward.begin(), reward.end(), 0.0f);
+  std::fill(done.begin(), done.end(), 0);
+}
+
+void env::VecEnv::step_range(
+  const std::size_t begin, const std::size_t end, const uint16_t *actions
+) {
+  for (std::size_t e = begin; e < end; e++) {
+    if (done[e]) {
+      reset_env(e);
+    }
+
+    qch_vm::machine &m = machines[e];
+    emu::virtual_clock &clock = clocks[e];
+    emu::set_key_mask(m, actions[e]);
+    emu::seed_random(random[e]);
+
+    const uint64_t target = clock.frames + config.frame_skip;
+    while (clock.frames < target && !m.quit) {
+      emu::step(m, clock);
+    }
+    random[e] = emu::random_state();
+
+    observe(e);
+    reward[e] = config.reward ? config.reward(e, m) : 0.0f;
+    done[e] = m.quit
+      || (config.max_frames > 0 && clock.frames >= config.max_frames)
+      || (config.done && config.done(e, m));
+  }
+}
+
+void env::VecEnv::step(const uint16_t *actions) {
+  if (pool.size() == 1) {
+    step_range(0, machines.size(), actions);
+    return;
+  }
+
+  for (std::size_t begin = 0; begin < machines.size(); begin += chunk) {
+    const std::size_t end = std::min(begin + chunk, machines.size());
+    pool.submit([this, begin, end, actions](const std::size_t){
+      step_range(begin, end, actions);
+    });
+  }
+  pool.wait();
+}
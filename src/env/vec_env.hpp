@@ -0,0 +1,91 @@
+#ifndef __VEC_ENV_HPP__
+#define __VEC_ENV_HPP__
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../emu/cycle.hpp"
+#include "../util/thread_pool.hpp"
+
+namespace env {
+  // called on a worker thread after every step of one environment, must be
+  // safe to call for different environments at the same time
+  using reward_f = std::function<float(
+    const std::size_t env, const qch_vm::machine &m
+  )>;
+  using done_f = std::function<bool(
+    const std::size_t env, const qch_vm::machine &m
+  )>;
+
+  struct config_t {
+    std::vector<uint8_t> program;
+    std::size_t envs = 1;
+    std::size_t threads = 0; // 0 = one per hardware thread
+    std::size_t frame_skip = 1; // 60hz frames per step
+    uint64_t max_frames = 0; // episode length, 0 = until the program quits
+    uint64_t seed = emu::default_seed; // env e draws CXNN from seed + e
+    reward_f reward; // 0 when unset
+    done_f done; // only quitting or max_frames end episodes when unset
+  };
+
+  // a batch of independent machines running one program, stepped together
+  //
+  // every step takes one key mask per environment and fills preallocated
+  // arrays: framebuffers as one byte per pixel (0 or 1) in env order,
+  // rewards and done flags. Environments that reported done start over
+  // from the loaded program on the next step. Work is split into one
+  // contiguous range of environments per pool thread.
+  class VecEnv {
+  public:
+    VecEnv(const config_t &config);
+
+    VecEnv(const VecEnv &) = delete;
+    VecEnv &operator=(const VecEnv &) = delete;
+
+    std::size_t size() const;
+
+    // bytes of one framebuffer in observations()
+    std::size_t observation_size() const;
+
+    // restarts every environment and fills observations()
+    void reset();
+
+    // `actions` holds size() key masks, bit k = key k
+    void step(const uint16_t *actions);
+
+    const uint8_t *observations() const;
+    const float *rewards() const;
+    const uint8_t *dones() const;
+
+    // frames since the environment's episode started
+    uint64_t frames(const std::size_t env) const;
+
+    const qch_vm::machine &machine(const std::size_t env) const;
+  private:
+    void reset_env(const std::size_t env);
+    void step_range(
+      const std::size_t begin, const std::size_t end, const uint16_t *actions
+    );
+    void observe(const std::size_t env);
+
+    config_t config;
+    qch_vm::machine initial;
+    std::size_t obs_size;
+
+    std::vector<qch_vm::machine> machines;
+    std::vector<emu::virtual_clock> clocks;
+    std::vector<uint64_t> random;
+
+    std::vector<uint8_t> obs;
+    std::vector<float> reward;
+    std::vector<uint8_t> done;
+
+    util::ThreadPool pool;
+    std::size_t chunk;
+  };
+}
+
+#endif // __VEC_ENV_HPP__
@@ -0,0 +1,42 @@
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+#include "coverage.hpp"
+
+bool fuzz::CoverageMap::merge(const local_coverage &local) {
+  bool added = false;
+
+  for (std::size_t i = 0; i < coverage_words; i++) {
+    const uint64_t w = local.words[i];
+    if (w == 0) { continue; }
+
+    // a relaxed read filters out the common case without a locked rmw
+    if ((w & ~words[i].load(std::memory_order_relaxed)) == 0) { continue; }
+
+    const uint64_t old = words[i].fetch_or(w, std::memory_order_relaxed);
+    added |= (w & ~old) != 0;
+  }
+
+  return added;
+}
+
+std::size_t fuzz::CoverageMap::pcs() const {
+  return count(0, pc_bits / 64);
+}
+
+std::size_t fuzz::CoverageMap::opcodes() const {
+  return count(pc_bits / 64, coverage_words);
+}
+
+std::size_t fuzz::CoverageMap::count(
+  const std::size_t first, const std::size_t last
+) const {
+  std::size_t n = 0;
+  for (std::size_t i = first; i < last; i++) {
+    n += std::bitset<64>(words[i].load(std::memory_order_relaxed)).count();
+  }
+
+  return n;
+}
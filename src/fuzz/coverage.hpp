@@ -0,0 +1,53 @@
+#ifndef __COVERAGE_HPP__
+#define __COVERAGE_HPP__
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace fuzz {
+  static constexpr std::size_t pc_bits = 0x1000;
+  static constexpr std::size_t opcode_bits = 0x10000;
+  static constexpr std::size_t coverage_words = (pc_bits + opcode_bits) / 64;
+
+  // drops immediate operands (NNN, NN) so loading every constant does not
+  // count as new coverage, register operands are kept
+  constexpr uint16_t opcode_feature(const uint16_t op) {
+    switch (op >> 12) {
+      case 0x0: return (op == 0x00e0 || op == 0x00ee) ? op : 0x0000;
+      case 0x1: case 0x2: case 0xa: case 0xb: return op & 0xf000;
+      case 0x3: case 0x4: case 0x6: case 0x7: case 0xc: return op & 0xff00;
+      default: return op;
+    }
+  }
+
+  // coverage of one execution, owned by a single worker
+  struct local_coverage {
+    std::array<uint64_t, coverage_words> words{};
+
+    void clear() { words.fill(0); }
+
+    void add(const uint16_t pc, const uint16_t opcode) {
+      const std::size_t p = pc & (pc_bits - 1);
+      const std::size_t o = pc_bits + opcode_feature(opcode);
+      words[p / 64] |= uint64_t(1) << (p % 64);
+      words[o / 64] |= uint64_t(1) << (o % 64);
+    }
+  };
+
+  // coverage shared by every worker, only ever grows
+  class CoverageMap {
+  public:
+    // returns true when `local` set any bit not seen before
+    bool merge(const local_coverage &local);
+
+    std::size_t pcs() const;
+    std::size_t opcodes() const;
+  private:
+    std::size_t count(const std::size_t first, const std::size_t last) const;
+
+    std::array<std::atomic<uint64_t>, coverage_words> words{};
+  };
+}
+
+#endif // __COVERAGE_HPP__
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mutator.hpp"
+
+// opcode templates, the zero nibbles are filled with random operands
+static const uint16_t opcode_templates[] = {
+  0x00e0, 0x00ee, 0x1000, 0x2000, 0x3000, 0x4000, 0x5000, 0x6000,
+  0x7000, 0x8000, 0x8001, 0x8002, 0x8003, 0x8004, 0x8005, 0x8006,
+  0x8007, 0x800e, 0x9000, 0xa000, 0xb000, 0xc000, 0xd000, 0xe09e,
+  0xe0a1, 0xf007, 0xf00a, 0xf015, 0xf018, 0xf01e, 0xf029, 0xf033,
+  0xf055, 0xf065
+};
+
+static uint16_t random_instruction(fuzz::Rng &rng) {
+  constexpr std::size_t count = sizeof(opcode_templates) / sizeof(uint16_t);
+  const uint16_t op = opcode_templates[rng.below(count)];
+  const uint16_t operands = rng.next() & 0x0fff;
+
+  // keep the fixed low bits of 0/5/8/9/E/F group opcodes
+  switch (op >> 12) {
+    case 0x0: return op;
+    case 0x5: case 0x9: return op | (operands & 0x0ff0);
+    case 0x8: return op | (operands & 0x0ff0);
+    case 0xe: case 0xf: return op | (operands & 0x0f00);
+    default: return op | operands;
+  }
+}
+
+static void put_instruction(
+  std::vector<uint8_t> &data, const std::size_t at, const uint16_t inst
+) {
+  if (at + 1 >= data.size()) { return; }
+  data[at] = inst >> 8;
+  data[at + 1] = inst & 0xff;
+}
+
+void fuzz::generate(Rng &rng, std::vector<uint8_t> &out) {
+  const std::size_t instructions = 1 + rng.below(256);
+  out.resize(instructions * 2);
+
+  for (std::size_t i = 0; i < instructions; i++) {
+    // jumps and calls mostly land inside the program
+    uint16_t inst = random_instruction(rng);
+    if ((inst >> 12) == 0x1 || (inst >> 12) == 0x2) {
+      inst = (inst & 0xf000) | (0x200 + 2 * rng.below(instructions));
+    }
+    put_instruction(out, i * 2, inst);
+  }
+}
+
+void fuzz::mutate(
+  Rng &rng, std::vector<uint8_t> &data, const std::vector<uint8_t> &other
+) {
+  if (data.empty()) {
+    generate(rng, data);
+    return;
+  }
+
+  const std::size_t stacked = 1 + rng.below(4);
+  for (std::size_t n = 0; n < stacked; n++) {
+    const std::size_t at = rng.below(data.size());
+
+    switch (rng.below(7)) {
+      case 0: // flip a bit
+        data[at] ^= 1 << rng.below(8);
+        break;
+      case 1: // random byte
+        data[at] = rng.next() & 0xff;
+        break;
+      case 2: // replace an aligned instruction
+        put_instruction(data, at & ~std::size_t(1), random_instruction(rng));
+        break;
+      case 3: // insert an instruction
+        if (data.size() + 2 <= max_program_size) {
+          const std::size_t pos = at & ~std::size_t(1);
+          const uint16_t inst = random_instruction(rng);
+          data.insert(data.begin() + pos, {uint8_t(inst >> 8), uint8_t(inst)});
+        }
+        break;
+      case 4: // delete an instruction
+        if (data.size() > 2) {
+          const std::size_t pos = std::min(at & ~std::size_t(1), data.size() - 2);
+          data.erase(data.begin() + pos, data.begin() + pos + 2);
+        }
+        break;
+      case 5: // duplicate a block
+        {
+          const std::size_t len = std::min(
+            1 + rng.below(32), data.size() - at
+          );
+          if (data.size() + len <= max_program_size) {
+            std::vector<uint8_t> block(data.begin() + at, data.begin() + at + len);
+            data.insert(data.begin() + rng.below(data.size()), block.begin(), block.end());
+          }
+        }
+        break;
+      case 6: // splice the tail of another input
+        if (!other.empty()) {
+          const std::size_t from = rng.below(other.size());
+          data.resize(at);
+          data.insert(data.end(), other.begin() + from, other.end());
+          data.resize(std::min(data.size(), max_program_size));
+        }
+        break;
+    }
+
+    if (data.empty()) {
+      generate(rng, data);
+    }
+  }
+}
@@ -0,0 +1,38 @@
+#ifndef __MUTATOR_HPP__
+#define __MUTATOR_HPP__
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fuzz {
+  // xorshift64*
+  class Rng {
+  public:
+    explicit Rng(uint64_t seed) : state(seed ? seed : 0x9e3779b97f4a7c15) {}
+
+    uint64_t next() {
+      state ^= state >> 12;
+      state ^= state << 25;
+      state ^= state >> 27;
+      return state * 0x2545f4914f6cdd1d;
+    }
+
+    // uniform enough for mutation choices, `n` must be non-zero
+    std::size_t below(const std::size_t n) { return next() % n; }
+  private:
+    uint64_t state;
+  };
+
+  // largest program that fits between 0x200 and the end of memory
+  static constexpr std::size_t max_program_size = 0x1000 - 0x200;
+
+  // random program of whole, mostly well formed instructions
+  void generate(Rng &rng, std::vector<uint8_t> &out);
+
+  // applies a few stacked mutations, `other` is used for splicing
+  void mutate(
+    Rng &rng, std::vector<uint8_t> &data, const std::vector<uint8_t> &other
+  );
+}
+
+#endif // __MUTATOR_HPP__
@@ -67,3 +67,12 @@ void drawRect(const Rect &r) {
 
   glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 }
+
+void drawRectInstanced(const Rect &r, const std::size_t count) {
+  if (current_vao != r.vao) {
+    glBindVertexArray(r.vao);
+    current_vao = r.vao;
+  }
+
+  glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, count);
+}
@@ -1,5 +1,6 @@
 #ifndef __RECT_HPP__
 #define __RECT_HPP__
+#include <cstddef>
 
 #include "glad.h"
 #include <GLFW/glfw3.h>
@@ -12,5 +13,6 @@ struct Rect {
 
 Rect createRect();
 void drawRect(const Rect &r);
+void drawRectInstanced(const Rect &r, const std::size_t count);
 
 #endif // __RECT_HPP__
@@ -70,3 +70,9 @@ void uniformMatrix4fv(
   GLuint loc = glGetUniformLocation(program, name);
   glUniformMatrix4fv(loc, 1, GL_FALSE, matrix);
 }
+
+void uniform2i(const GLuint program, const char *name, const int x, const int y) {
+  glUseProgram(program);
+  GLuint loc = glGetUniformLocation(program, name);
+  glUniform2i(loc, x, y);
+}
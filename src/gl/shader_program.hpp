@@ -19,4 +19,6 @@ void uniformMatrix4fv(
   const GLuint program, const char *name, const GLfloat *matrix
 );
 
+void uniform2i(const GLuint program, const char *name, const int x, const int y);
+
 #endif // __SHADER_PROGRAM_HPP__
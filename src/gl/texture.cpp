@@ -40,3 +40,62 @@ void bindTexture(const Texture &t) {
     current_texture = t.id;
   }
 }
+
+Texture create_index_texture(
+  const std::size_t width, const std::size_t height
+) {
+  GLuint texture;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage2D(
+    GL_TEXTURE_2D, 0, GL_R8UI, width, height, 0,
+    GL_RED_INTEGER, GL_UNSIGNED_BYTE, nullptr
+  );
+
+  glBindTexture(GL_TEXTURE_2D, current_texture);
+
+  return {texture};
+}
+
+void deleteTexture(Texture &t) {
+  if (current_texture == t.id) {
+    glBindTexture(GL_TEXTURE_2D, 0);
+    current_texture = 0;
+  }
+
+  glDeleteTextures(1, &t.id);
+  t.id = 0;
+}
+
+Texture create_texture_array(
+  const std::size_t width, const std::size_t height, const std::size_t layers
+) {
+  GLuint texture;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+  glTexImage3D(
+    GL_TEXTURE_2D_ARRAY, 0, GL_R8, width, height, layers, 0,
+    GL_RED, GL_UNSIGNED_BYTE, nullptr
+  );
+
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+  return {texture};
+}
+
+void bindTextureArray(const Texture &t) {
+  glBindTexture(GL_TEXTURE_2D_ARRAY, t.id);
+}
@@ -17,4 +17,16 @@ Texture create_texture_from_data(
 
 void bindTexture(const Texture &t);
 
+// unsigned integer single channel texture, sampled with a usampler2D
+Texture create_index_texture(const std::size_t width, const std::size_t height);
+
+void deleteTexture(Texture &t);
+
+// single channel 2d array texture, one layer per image
+Texture create_texture_array(
+  const std::size_t width, const std::size_t height, const std::size_t layers
+);
+
+void bindTextureArray(const Texture &t);
+
 #endif // __TEXTURE_HPP__
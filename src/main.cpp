@@ -1,170 +1,133 @@
-#include <array>
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <filesystem>
 #include <iostream>
 #include <limits>
-#include <map>
+#include <memory>
+#include <optional>
+#include <random>
 #include <regex>
-
-#include "glad.h"
-#include <GLFW/glfw3.h>
-
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
+#include <string>
+#include <thread>
 
 #include <qxdg/qxdg.hpp>
 #include <qfio/qfio.hpp>
 
 #include <qch_vm/qch_vm.hpp>
 
-#include "gl/rect.hpp"
-#include "gl/shader_program.hpp"
-#include "gl/texture.hpp"
-#include "gl/window.hpp"
+#ifndef HEADLESS
+#include "render/gl_renderer.hpp"
+#endif
+#include "capture/frame_writer.hpp"
+#include "control/server.hpp"
+#include "control/shared_state.hpp"
+#include "emu/cycle.hpp"
+#include "emu/input_script.hpp"
+#include "emu/movie.hpp"
+#include "emu/opcode_stats.hpp"
+#include "emu/profiler.hpp"
+#include "emu/rewind.hpp"
+#include "emu/run_ahead.hpp"
+#include "emu/seek.hpp"
+#include "emu/snapshot.hpp"
+#include "emu/state.hpp"
+#include "emu/trace.hpp"
+#include "modes/bench.hpp"
+#include "modes/farm.hpp"
+#include "modes/fuzz.hpp"
+#include "modes/headless.hpp"
+#include "modes/trace.hpp"
+#include "modes/verify.hpp"
+#include "modes/wall.hpp"
+#include "render/curses_renderer.hpp"
+#include "render/renderer.hpp"
+#include "render/soft_renderer.hpp"
+#include "util/async_log.hpp"
 #include "util/error.hpp"
+#include "util/frame_stats.hpp"
+#include "util/options.hpp"
 #include "util/timer.hpp"
 
-static constexpr int window_width = 640;
-static constexpr int window_height = 480;
-static constexpr int gl_major_version = 3;
-static constexpr int gl_minor_version = 3;
-
-static const std::map<int, uint8_t> key_map = {
-  {GLFW_KEY_X, 0x0},
-  {GLFW_KEY_1, 0x1},
-  {GLFW_KEY_2, 0x2},
-  {GLFW_KEY_3, 0x3},
-  {GLFW_KEY_Q, 0x4},
-  {GLFW_KEY_W, 0x5},
-  {GLFW_KEY_E, 0x6},
-  {GLFW_KEY_A, 0x7},
-  {GLFW_KEY_S, 0x8},
-  {GLFW_KEY_D, 0x9},
-  {GLFW_KEY_Z, 0xa},
-  {GLFW_KEY_C, 0xb},
-  {GLFW_KEY_4, 0xc},
-  {GLFW_KEY_R, 0xd},
-  {GLFW_KEY_F, 0xe},
-  {GLFW_KEY_V, 0xf}
-};
-
-constexpr timing::seconds loop_timestep(1.0/500.0);
-constexpr timing::seconds timer_timestep(1.0/60.0);
-static const std::regex program_re(R"re(.*(\.ch8)$)re");
+constexpr timing::seconds loop_timestep(1.0/emu::cycles_per_second);
+constexpr timing::seconds timer_timestep(1.0/emu::timer_frequency);
 
-#ifdef DEBUG
-namespace xdg {
-  std::optional<xdg::path_t> get_data_path(
-    const xdg::base &b, const std::string &n, const std::string &p,
-    fio::log_stream_f &log_stream, const bool create=false
-  );
-}
-namespace fio {
-  std::optional<xdg::path_t> read(
-    const xdg::path_t &path, fio::log_stream_f &log_stream
-  );
-}
-#endif
+// loop iterations between updates of the frame time overlay
+constexpr std::size_t hud_refresh = 15;
+constexpr uint64_t seek_frames = 10 * emu::timer_frequency;
+static const std::regex program_re(R"re(.*(\.ch8)$)re");
 
-void processInput(GLFWwindow *window, qch_vm::machine &m);
-std::array<glm::mat4, 3> fullscreen_rect_matrices(const int w, const int h);
+std::string choose_program(const xdg::base &base_dirs);
 
 int main(int argc, const char *argv[]) {
-  // get base directories and init logger
-  xdg::base base_dirs = xdg::get_base_directories();
-  auto log_path = xdg::get_data_path(base_dirs, "qchip", "logs/qchip.log", true);
-  fio::log_stream_f log_stream(*log_path);
-  log_stream << "GLFW Version: " << glfwGetVersionString() << "\n";
-
-  auto program_files = xdg::search_data_dirs(base_dirs, "qchip", program_re);
-
-  int index = 0;
-  while ((index < 1) || (index > program_files.size())) {
-    std::cout << "Choose program!\n";
-    for (int i = 0; i < program_files.size(); i++) {
-      std::cout << (i + 1) << ") " << program_files[i] << "\n";
-    }
-
-    std::cin >> index;
-    if (std::cin.fail()) {
-      std::cin.clear();
-      std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-    }
+  auto opts = parse_options(argc, argv);
+  if (!opts) {
+    return to_underlying(error_code_t::invalid_args);
   }
 
-  std::string program_path = program_files[index - 1];
+  // reports counted opcodes however main returns, nothing without
+  // OPCODE_STATS
+  emu::OpcodeReport opcode_report(opts->opcode_stats_path);
 
-  // create opengl window and context
-  GLFWwindow *window = createWindow(
-    gl_major_version, gl_minor_version, true, window_width, window_height,
-    "qChip8"
-  );
-
-  if (window == nullptr) {
-    #ifdef DEBUG
-    log_stream << "failed to create window\n";
-    #endif
+  if (opts->bench) {
+    return modes::run_opcode_bench(*opts);
+  }
 
-    glfwDestroyWindow(window);
-    return to_underlying(error_code_t::window_failed);
+  if (opts->decode_trace_path) {
+    return modes::run_decode_trace(*opts);
   }
 
-  glfwMakeContextCurrent(window);
+  // get base directories and init logger
+  xdg::base base_dirs = xdg::get_base_directories();
+  auto log_path = xdg::get_data_path(base_dirs, "qchip", "logs/qchip.log", true);
+  logging::AsyncLog log_stream(*log_path);
 
-  // load opengl functions
-  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-    #ifdef DEBUG
-    log_stream << "failed to initialise GLAD\n";
-    #endif
+  if (opts->farm) {
+    return modes::run_farm(*opts, base_dirs, log_stream);
+  }
 
-    return to_underlying(error_code_t::glad_failed);
+  if (opts->fuzz_dir) {
+    return modes::run_fuzz(*opts, base_dirs, log_stream);
   }
 
-  glViewport(0, 0, window_width, window_height);
-  glClearColor(0.1, 0.1, 0.2, 1.0);
+  if (opts->verify_path) {
+    return modes::run_verify(*opts, log_stream);
+  }
 
-  log_stream << "OpenGL Version: " << glGetString(GL_VERSION) << "\n";
+  if (opts->bench_roms_path) {
+    return modes::run_rom_bench(*opts, log_stream);
+  }
 
-  // load shaders
-  auto v_shader_path = xdg::get_data_path(
-    base_dirs, "qchip", "shaders/tex/vshader.glsl"
-    #ifdef DEBUG
-    , log_stream
-    #endif
-  );
-  auto v_shader_string = fio::read(*v_shader_path);
+  if (opts->headless) {
+    return modes::run_headless(*opts, log_stream);
+  }
 
-  auto f_shader_path = xdg::get_data_path(
-    base_dirs, "qchip", "shaders/tex/fshader.glsl"
-    #ifdef DEBUG
-    , log_stream
-    #endif
-  );
-  auto f_shader_string = fio::read(*f_shader_path);
+  std::string program_path = opts->program_path
+    ? *opts->program_path
+    : choose_program(base_dirs);
 
-  GLuint v_shader = createShader(GL_VERTEX_SHADER, *v_shader_string);
-  GLuint f_shader = createShader(GL_FRAGMENT_SHADER, *f_shader_string);
-  #ifdef DEBUG
-  const auto v_compile_error = getCompileStatus(v_shader);
-  if (v_compile_error) {
-    log_stream << "vertex shader compilation failed\n";
-    log_stream << *v_compile_error << "\n";
-  }
-  const auto f_compile_error = getCompileStatus(f_shader);
-  if (f_compile_error) {
-    log_stream << "fragment shader compilation failed\n";
-    log_stream << *f_compile_error << "\n";
+  #ifndef HEADLESS
+  if (opts->instances > 1) {
+    return modes::run_wall(*opts, base_dirs, log_stream, program_path);
   }
   #endif
 
-  GLuint shader_program = createProgram(v_shader, f_shader, true);
-  #ifdef DEBUG
-  const auto link_error = getLinkStatus(shader_program);
-  if (link_error) {
-    log_stream << "shader program link failed\n";
-    log_stream << *link_error << "\n";
+  // pick display backend, the software path never touches glfw or opengl
+  std::unique_ptr<render::Renderer> renderer;
+  if (opts->backend == render::backend_t::soft) {
+    renderer = std::make_unique<render::SoftRenderer>(
+      opts->scale, opts->frame_dir, opts->frame_format
+    );
+  } else if (opts->backend == render::backend_t::curses) {
+    renderer = std::make_unique<render::CursesRenderer>();
+  }
+  #ifndef HEADLESS
+  else {
+    auto gl_renderer = std::make_unique<render::GLRenderer>();
+    if (auto error = gl_renderer->init(base_dirs, log_stream)) {
+      return to_underlying(*error);
+    }
+    renderer = std::move(gl_renderer);
   }
   #endif
 
@@ -172,166 +135,354 @@ int main(int argc, const char *argv[]) {
   qch_vm::machine m;
   m.draw = true; // force screen refresh at program start
 
-  // initialise texture
-  constexpr std::size_t num_cols = m.display_width;
-  constexpr std::size_t num_rows = m.display_height;
-  constexpr std::size_t num_channels = 1;
-  constexpr std::size_t image_stride = num_cols * num_channels;
-  constexpr std::size_t data_size = num_cols*num_rows*num_channels;
-  unsigned char data[num_cols*num_rows*num_channels];
-
-  for (int i = 0; i < data_size; i++) {
-    data[i] = 0;
-  }
-
-  Texture texture = create_texture_from_data(
-    num_cols, num_rows, num_channels, data
-  );
-  // create screen rect
-  Rect rect = createRect();
-
-  auto [projection, view, model] = fullscreen_rect_matrices(
-    window_width, window_height
-  );
-
-  uniformMatrix4fv(shader_program, "projection", glm::value_ptr(projection));
-  uniformMatrix4fv(shader_program, "view", glm::value_ptr(view));
-  uniformMatrix4fv(shader_program, "model", glm::value_ptr(model));
-
   // load program from file
   auto program_data = fio::readb(program_path);
   if (!program_data) { log_stream << "could not read file"; }
   log_stream << "loading program ...\n--> " << program_path << "\n";
   log_stream << "--> " << program_data->size() << " bytes read" << "\n";
   qch_vm::load_program(m, *program_data);
+  const uint64_t program_hash = emu::hash_bytes(
+    program_data->data(), program_data->size()
+  );
+
+  // a replayed movie drives the keypad and fixes the seed, recordings store
+  // the seed they ran with
+  std::optional<emu::movie> movie;
+  if (opts->replay_path) {
+    movie = emu::read_movie(*opts->replay_path);
+    if (!movie || movie->header.program_hash != program_hash) {
+      log_stream << "could not replay " << *opts->replay_path << "\n";
+      return to_underlying(error_code_t::invalid_args);
+    }
+  }
+  const uint64_t seed = movie
+    ? movie->header.seed
+    : opts->seed.value_or(std::random_device()());
+  emu::seed_random(seed);
+  emu::InputPlayer player(movie ? &movie->inputs : nullptr);
+
+  std::unique_ptr<emu::MovieRecorder> recorder;
+  if (opts->record_path) {
+    recorder = std::make_unique<emu::MovieRecorder>(
+      *opts->record_path, emu::movie_header{
+        program_hash, seed, emu::cycles_per_second, emu::timer_frequency
+      }
+    );
+    if (!recorder->good()) {
+      log_stream << "could not open " << *opts->record_path << "\n";
+    }
+  }
+
+  // replays can be scrubbed, page up and page down jump 10 seconds
+  std::unique_ptr<emu::Seeker> seeker;
+  if (movie) {
+    seeker = std::make_unique<emu::Seeker>(m, &movie->inputs, seed);
+  }
+
+  // restoring earlier states would make recordings impossible to replay
+  const bool deterministic = opts->record_path || opts->replay_path;
+
+  // save states, f5 saves and f9 restores the most recent one
+  const std::string state_path = opts->state_path
+    ? *opts->state_path
+    : *xdg::get_data_path(
+      base_dirs, "qchip",
+      "states/" + std::filesystem::path(program_path).stem().string() + ".state",
+      true
+    );
+  emu::SaveStates save_states(state_path, program_hash);
+  if (opts->load_state && !deterministic) {
+    if (save_states.load(m)) {
+      m.draw = true;
+    } else {
+      log_stream << "no save state in " << state_path << "\n";
+    }
+  }
+
+  // history for rewinding while backspace is held, one entry per 60hz frame
+  std::unique_ptr<emu::RewindBuffer> rewind;
+  if (opts->rewind_seconds > 0 && !deterministic) {
+    rewind = std::make_unique<emu::RewindBuffer>(
+      opts->rewind_memory * 1024, opts->rewind_seconds * emu::timer_frequency
+    );
+  }
+
+  // the display shows the machine a few frames ahead of where it really is
+  std::unique_ptr<emu::RunAhead> run_ahead;
+  if (opts->run_ahead > 0) {
+    run_ahead = std::make_unique<emu::RunAhead>(opts->run_ahead);
+  }
+
+  // automation clients share the machine with the keyboard and the wall clock
+  std::unique_ptr<control::Server> control;
+  if (opts->control_path) {
+    control = std::make_unique<control::Server>(*opts->control_path);
+    if (!control->good()) {
+      log_stream << "could not listen on " << *opts->control_path << "\n";
+    }
+  }
+
+  // external tools read the machine from shared memory, updated once per
+  // displayed frame after steps, loads, seeks and rewinding
+  std::unique_ptr<control::SharedState> shared_state;
+  if (opts->shm_name) {
+    shared_state = std::make_unique<control::SharedState>(*opts->shm_name);
+    if (!shared_state->good()) {
+      log_stream << "could not create shared memory " << *opts->shm_name << "\n";
+    }
+  }
+
+  // instruction profile of the whole session, written on exit
+  std::unique_ptr<emu::Profiler> profiler;
+  if (opts->profile_prefix) {
+    profiler = std::make_unique<emu::Profiler>();
+  }
+
+  std::unique_ptr<capture::FrameWriter> frame_writer;
+  if (opts->capture_path) {
+    frame_writer = std::make_unique<capture::FrameWriter>(
+      *opts->capture_path, opts->capture_format, opts->capture_scale
+    );
+    if (!frame_writer->good()) {
+      log_stream << "could not open capture output\n";
+    }
+  }
 
+  std::optional<emu::TraceRing> trace;
+  if (opts->trace_path) {
+    trace.emplace(opts->trace_size);
+    emu::trace_to(&*trace);
+  }
+
+  // cycles are paced by the wall clock, timers follow emulated time so a run
+  // only depends on its input
+  emu::virtual_clock emu_clock;
   timing::Clock clock;
   timing::Timer loop_timer;
   timing::seconds loop_accumulator(0.0);
-  timing::Timer timer_timer;
-  timing::seconds timer_accumulator(0.0);
 
-  while (!m.quit && !glfwWindowShouldClose(window)) {
+  // every iteration is timed by phase, the overlay shows the percentiles
+  timing::FrameStats frame_stats;
+  bool hud = opts->hud;
+  std::size_t hud_countdown = 0;
+  timing::seconds upload_time(0.0);
+
+  // uploads happen inside other phases but are counted as output
+  auto upload = [&](const qch_vm::machine &frame) {
+    const timing::seconds start = clock.get();
+    renderer->upload(frame);
+    upload_time += clock.get() - start;
+  };
+
+  // the soft backend has no window to close, it stops at the cycle budget
+  const uint64_t cycle_budget = opts->backend == render::backend_t::soft
+    ? opts->cycles
+    : std::numeric_limits<uint64_t>::max();
+
+  while (!m.quit && !renderer->shouldClose()
+    && emu_clock.cycles < cycle_budget) {
     loop_accumulator += loop_timer.getDelta();
-    loop_timer.tick(clock.get());
+    const timing::seconds loop_start = clock.get();
+    loop_timer.tick(loop_start);
+    upload_time = timing::seconds(0.0);
 
     //process input
-    glfwPollEvents();
-    processInput(window, m);
-
-    while (loop_accumulator >= loop_timestep) {
-      if (!m.blocking) {
-        if (m.halted) {
-          loop_accumulator -= loop_timestep;
-          continue;
+    const uint16_t keys = emu::key_mask(m);
+    renderer->processInput(m);
+    if (movie || (control && control->connected())) {
+      emu::set_key_mask(m, keys);
+    }
+    if (recorder) {
+      recorder->record(emu_clock.cycles, m);
+    }
+
+    if (control) {
+      if (control->service(m, emu_clock) && rewind) {
+        rewind->clear();
+      }
+
+      // paused clients step the machine themselves
+      if (control->paused()) {
+        loop_accumulator = timing::seconds(0.0);
+        if (m.draw) {
+          upload(m);
+          m.draw = false;
         }
+      }
+    }
 
-        qch::instruction inst = qch_vm::fetch_instruction(m);
-        qch_vm::fn f = qch_vm::decode_instruction(inst);
-        f(m, inst);
+    const uint32_t hotkeys = renderer->takeHotkeys();
+    if (hotkeys & to_underlying(render::hotkey_t::save_state)) {
+      save_states.save(m);
+    }
+    if (hotkeys & to_underlying(render::hotkey_t::opcode_stats)) {
+      opcode_report.write();
+    }
+    if (hotkeys & to_underlying(render::hotkey_t::hud)) {
+      hud = !hud;
+      hud_countdown = 0;
+      if (!hud) {
+        renderer->setOverlay({});
+      }
+    }
+    if (hotkeys & to_underlying(render::hotkey_t::load_state)
+      && !deterministic) {
+      if (save_states.load(m)) {
+        m.draw = true;
+      }
+    }
+
+    if (seeker && hotkeys & (to_underlying(render::hotkey_t::seek_back)
+      | to_underlying(render::hotkey_t::seek_forward))) {
+      const uint64_t frame = emu_clock.frames;
+      seeker->seek(
+        hotkeys & to_underlying(render::hotkey_t::seek_back)
+          ? frame - std::min(frame, seek_frames)
+          : frame + seek_frames,
+        m, emu_clock, player
+      );
+      m.draw = true;
+    }
+
+    const timing::seconds input_end = clock.get();
+    frame_stats.add(
+      timing::phase_t::input, input_end - loop_start - upload_time
+    );
+    const timing::seconds input_uploads = upload_time;
+
+    const bool rewinding = rewind
+      && (renderer->heldHotkeys() & to_underlying(render::hotkey_t::rewind));
+
+    if (rewinding) {
+      // play recorded frames backwards at 60hz, the program does not run
+      while (loop_accumulator >= timer_timestep) {
+        if (rewind->pop(m)) {
+          upload(m);
+        }
+        loop_accumulator -= timer_timestep;
+      }
+    }
 
-        #ifdef DEBUG
-        if (m.debug_enabled) {
-          std::cout << m.debug_out << "\n";
+    std::size_t slots = 0;
+    bool stepped = false;
+    while (!rewinding && loop_accumulator >= loop_timestep
+      && emu_clock.cycles < cycle_budget) {
+      player.apply(emu_clock.cycles, m);
+      if (profiler) {
+        profiler->record(m);
+      }
+      if (emu::step(m, emu_clock)) {
+        // captured video gets every emulated frame, whatever the wall clock
+        if (frame_writer) {
+          frame_writer->push(m);
         }
-        #endif
-
-        timer_accumulator += timer_timer.getDelta();
-        timer_timer.tick(clock.get());
-        while (timer_accumulator >= timer_timestep) {
-          // reduce timers
-          --m.delay_timer;
-          --m.sound_timer;
-          timer_accumulator -= timer_timestep;
+        if (rewind) {
+          rewind->push(m);
+        }
+        if (seeker) {
+          seeker->observe(m, emu_clock);
         }
-      } else {
-        qch_vm::get_key(m);
       }
 
       if (m.draw) {
-        bindTexture(texture);
-        glTexSubImage2D(
-          GL_TEXTURE_2D, 0, 0, 0, m.display_width, m.display_height,
-          GL_RED, GL_UNSIGNED_BYTE, m.gfx.data()
-        );
-        bindTexture({0});
+        if (!run_ahead) {
+          upload(m);
+        }
         m.draw = false;
       }
 
+      stepped = true;
+      slots++;
       loop_accumulator -= loop_timestep;
     }
 
-    // draw screen texture
-    glClear(GL_COLOR_BUFFER_BIT);
+    if (stepped && run_ahead && run_ahead->run(m, emu_clock)) {
+      upload(run_ahead->machine());
+    }
 
-    glUseProgram(shader_program);
-    bindTexture(texture);
-    drawRect(rect);
-    glfwSwapBuffers(window);
-  }
+    const timing::seconds emulate_end = clock.get();
+    frame_stats.add(
+      timing::phase_t::emulate,
+      emulate_end - input_end - (upload_time - input_uploads)
+    );
 
-  #ifdef DEBUG
-  // std::cout << dump_memory(m) << "\n";
-  // std::cout << dump_graphics_data(m) << "\n";
-  std::cout << dump_registers(m) << "\n";
-  #endif
-
-  return 0;
-}
+    if (shared_state) {
+      shared_state->publish(m, emu_clock);
+    }
 
-#ifdef DEBUG
-std::optional<xdg::path_t> xdg::get_data_path(
-  const xdg::base &b, const std::string &n, const std::string &p,
-  fio::log_stream_f &log_stream, const bool create
-) {
-  log_stream << "Fetching path: " << p << "\n";
-  auto path = xdg::get_data_path(b, n, p);
-  if (!path) {
-    log_stream << "[w] `" << p << "` not found...\n";
-  } else {
-    log_stream << "--> " << *path << "\n";
-  }
+    const timing::seconds output_end = clock.get();
+    frame_stats.add(
+      timing::phase_t::output, output_end - emulate_end + upload_time
+    );
 
-  return path;
-}
+    if (hud && hud_countdown-- == 0) {
+      renderer->setOverlay(frame_stats.summary());
+      hud_countdown = hud_refresh;
+    }
 
-std::optional<xdg::path_t> fio::read(
-  const xdg::path_t &path, fio::log_stream_f &log_stream
-) {
-  log_stream << "Loading file: " << path << "\n";
-  auto data = fio::read(path);
-  if (!data) {
-    log_stream << "[w] Could not read file...\n";
+    // draw screen
+    renderer->draw();
+
+    const timing::seconds loop_end = clock.get();
+    frame_stats.add(
+      timing::phase_t::draw, loop_end - output_end - renderer->presentTime()
+    );
+    frame_stats.add(timing::phase_t::swap, renderer->presentTime());
+
+    // backends without vsync would spin, wait until the next cycle is due;
+    // the wait belongs to the frame, whose emulated time it lets build up
+    const timing::seconds idle =
+      loop_timestep - loop_accumulator - (loop_end - loop_start);
+    if (idle.count() > 0.0) {
+      std::this_thread::sleep_for(idle);
+    }
+    frame_stats.endFrame(clock.get() - loop_start, slots * loop_timestep);
   }
 
-  return data;
-}
-#endif
+  for (const std::string &line : frame_stats.summary()) {
+    log_stream << line << "\n";
+  }
 
-void processInput(GLFWwindow *window, qch_vm::machine &m) {
-  if(glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
-    glfwSetWindowShouldClose(window, true);
+  if (recorder) {
+    recorder->finish(emu_clock.cycles, m);
   }
 
-  for (auto &[k, v] : key_map) {
-    int state = glfwGetKey(window, k);
+  if (profiler && !profiler->write(*opts->profile_prefix, m)) {
+    log_stream << "could not write profile " << *opts->profile_prefix << "\n";
+  }
 
-    if (state == GLFW_PRESS) {
-      m.keys[v] = true;
-    } else if (state == GLFW_RELEASE) {
-      m.keys[v] = false;
+  if (trace) {
+    emu::trace_to(nullptr);
+    if (!trace->write(*opts->trace_path)) {
+      log_stream << "could not write trace " << *opts->trace_path << "\n";
     }
   }
+
+  #ifdef DEBUG
+  // std::cout << dump_memory(m) << "\n";
+  // std::cout << dump_graphics_data(m) << "\n";
+  std::cout << dump_registers(m) << "\n";
+  #endif
+
+  return 0;
 }
 
-std::array<glm::mat4, 3> fullscreen_rect_matrices(const int w, const int h) {
-  glm::mat4 projection = glm::ortho<double>(0, w, 0, h, 0.1, 100.0);
+std::string choose_program(const xdg::base &base_dirs) {
+  auto program_files = xdg::search_data_dirs(base_dirs, "qchip", program_re);
 
-  glm::mat4 view = glm::mat4(1.0);
-  view = glm::translate(view, glm::vec3(0.0, 0.0, -1.0));
+  int index = 0;
+  while ((index < 1) || (index > program_files.size())) {
+    std::cout << "Choose program!\n";
+    for (int i = 0; i < program_files.size(); i++) {
+      std::cout << (i + 1) << ") " << program_files[i] << "\n";
+    }
 
-  glm::mat4 model = glm::mat4(1.0);
-  model = glm::scale(model, glm::vec3(w, h, 1));
+    std::cin >> index;
+    if (std::cin.fail()) {
+      std::cin.clear();
+      std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+  }
 
-  return {projection, view, model};
+  return program_files[index - 1];
 }
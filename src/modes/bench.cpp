@@ -0,0 +1,335 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <qfio/qfio.hpp>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../emu/cycle.hpp"
+#include "../emu/input_script.hpp"
+#include "../emu/state.hpp"
+#include "../render/soft_renderer.hpp"
+#include "../util/async_log.hpp"
+#include "../util/error.hpp"
+#include "../util/manifest.hpp"
+#include "../util/options.hpp"
+#include "../util/report.hpp"
+#include "../util/timer.hpp"
+#include "bench.hpp"
+
+static constexpr uint16_t data_address = 0x400;
+static constexpr std::size_t repeats = 5;
+
+struct bench_case {
+  const char *group;
+  const char *name;
+  uint16_t opcode;
+};
+
+// registers are preset to: V0 = 0x00, V1 = 0x5a, V2 = 0x33, V3 = 0x5a,
+// V4 = 0x0f (x), V5 = 0x07 (y), V6 = 0x3c (x), V7 = 0x1e (y), VF = 0x01
+// key and font opcodes read V4, the only register holding a hex digit
+static const std::vector<bench_case> cases = {
+  {"load", "6XNN ld", 0x6142},
+  {"load", "7XNN add", 0x7142},
+  {"load", "ANNN ld i", 0xa400},
+  {"load", "CXNN rnd", 0xc1ff},
+
+  {"alu", "8XY0 ld", 0x8120},
+  {"alu", "8XY1 or", 0x8121},
+  {"alu", "8XY2 and", 0x8122},
+  {"alu", "8XY3 xor", 0x8123},
+  {"alu", "8XY4 add", 0x8124},
+  {"alu", "8XY5 sub", 0x8125},
+  {"alu", "8XY6 shr", 0x8126},
+  {"alu", "8XY7 subn", 0x8127},
+  {"alu", "8XYE shl", 0x812e},
+
+  {"flow", "1NNN jp", 0x1200},
+  {"flow", "BNNN jp v0", 0xb200},
+  {"flow", "2NNN call", 0x2200},
+  {"flow", "00EE ret", 0x00ee},
+
+  {"skip", "3XNN taken", 0x315a},
+  {"skip", "3XNN not taken", 0x3100},
+  {"skip", "4XNN taken", 0x4100},
+  {"skip", "5XY0 taken", 0x5130},
+  {"skip", "9XY0 taken", 0x9120},
+  {"skip", "EX9E not taken", 0xe49e},
+  {"skip", "EXA1 taken", 0xe4a1},
+
+  {"memory", "FX1E add i", 0xf11e},
+  {"memory", "FX29 font", 0xf429},
+  {"memory", "FX33 bcd", 0xf133},
+  {"memory", "FX55 store v0", 0xf055},
+  {"memory", "FX55 store v0-v7", 0xf755},
+  {"memory", "FX55 store v0-vf", 0xff55},
+  {"memory", "FX65 load v0", 0xf065},
+  {"memory", "FX65 load v0-v7", 0xf765},
+  {"memory", "FX65 load v0-vf", 0xff65},
+
+  {"draw", "00E0 cls", 0x00e0},
+  {"draw", "DXYN h1 aligned", 0xd001},
+  {"draw", "DXYN h5 aligned", 0xd005},
+  {"draw", "DXYN h8 aligned", 0xd008},
+  {"draw", "DXYN h15 aligned", 0xd00f},
+  {"draw", "DXYN h5 unaligned", 0xd455},
+  {"draw", "DXYN h15 unaligned", 0xd45f},
+  {"draw", "DXYN h5 wrapping", 0xd675},
+  {"draw", "DXYN h15 wrapping", 0xd67f}
+};
+
+static void reset(qch_vm::machine &m) {
+  m.pc = emu::program_start;
+  m.I = data_address;
+  m.sp = 1;
+  m.stack[0] = emu::program_start;
+}
+
+static double time_case(const bench_case &c, const uint64_t iterations) {
+  qch_vm::machine m;
+  qch_vm::load_program(m, {
+    static_cast<uint8_t>(c.opcode >> 8), static_cast<uint8_t>(c.opcode & 0xff)
+  });
+
+  const uint8_t registers[16] = {
+    0x00, 0x5a, 0x33, 0x5a, 0x0f, 0x07, 0x3c, 0x1e,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01
+  };
+  std::copy(std::begin(registers), std::end(registers), std::begin(m.V));
+
+  // the best of several repeats hides scheduler noise
+  double best = 0.0;
+  timing::Clock clock;
+  for (std::size_t r = 0; r < repeats; r++) {
+    const timing::seconds start = clock.get();
+    for (uint64_t i = 0; i < iterations; i++) {
+      // emu::cycle is the path the emulator runs, CXNN included
+      reset(m);
+      emu::cycle(m);
+    }
+    const double ns = (clock.get() - start).count() * 1e9 / iterations;
+    best = (r == 0) ? ns : std::min(best, ns);
+  }
+
+  return best;
+}
+
+int modes::run_opcode_bench(const options_t &opts) {
+  const uint64_t iterations = opts.bench_iterations;
+
+  std::printf("{\n");
+  std::printf("  \"benchmark\": \"opcodes\",\n");
+  std::printf(
+    "  \"iterations\": %llu,\n", static_cast<unsigned long long>(iterations)
+  );
+  std::printf("  \"repeats\": %zu,\n", repeats);
+  std::printf("  \"results\": [\n");
+
+  for (std::size_t i = 0; i < cases.size(); i++) {
+    const bench_case &c = cases[i];
+    const double ns = time_case(c, iterations);
+
+    std::printf(
+      "    {\"group\": \"%s\", \"name\": \"%s\", \"opcode\": \"%04x\", "
+      "\"ns_per_instruction\": %.3f}%s\n",
+      c.group, report::json_escape(c.name).c_str(), c.opcode, ns,
+      (i + 1 < cases.size()) ? "," : ""
+    );
+  }
+
+  std::printf("  ]\n}\n");
+
+  return 0;
+}
+
+// thresholds written by --update leave this much headroom
+static constexpr double speed_margin = 0.8;
+static constexpr double rss_margin = 1.25;
+
+static std::optional<double> parse_threshold(const std::string &s);
+static void reset_peak_rss();
+static long peak_rss_kib();
+
+int modes::run_rom_bench(const options_t &opts, logging::AsyncLog &log_stream) {
+  namespace fs = std::filesystem;
+  const fs::path manifest_path = *opts.bench_roms_path;
+  const fs::path base = manifest_path.parent_path();
+
+  auto text = fio::read(manifest_path.string());
+  if (!text) {
+    std::cerr << "could not read manifest: " << manifest_path << "\n";
+    return to_underlying(error_code_t::invalid_args);
+  }
+  log_stream << "rom benchmark " << manifest_path.string() << "\n";
+
+  // <rom> <script | -> <emulated seconds> <min speed | -> <max rss kib | ->
+  auto lines = manifest::parse(*text);
+  bool regressed = false;
+  bool first = true;
+
+  std::printf("{\n  \"benchmark\": \"roms\",\n  \"results\": [\n");
+
+  for (std::size_t i = 0; i < lines.size(); i++) {
+    auto &fields = lines[i].fields;
+    if (fields.empty()) { continue; }
+
+    const auto seconds = fields.size() == 5
+      ? parse_size(fields[2])
+      : std::nullopt;
+    if (!seconds) {
+      std::cerr << "malformed manifest line " << (i + 1) << "\n";
+      return to_underlying(error_code_t::invalid_args);
+    }
+
+    auto program_data = fio::readb((base / fields[0]).string());
+    std::optional<emu::input_script> script;
+    if (fields[1] != "-") {
+      auto script_text = fio::read((base / fields[1]).string());
+      if (script_text) {
+        script = emu::parse_input_script(fields[1], *script_text);
+      }
+    }
+    if (!program_data || (fields[1] != "-" && !script)) {
+      std::cerr << "could not load " << fields[0] << " " << fields[1] << "\n";
+      return to_underlying(error_code_t::invalid_args);
+    }
+
+    // the peak covers this program only, not the ones before it
+    reset_peak_rss();
+
+    // every repeat replays the same run, the fastest one is reported
+    emu::virtual_clock clock;
+    uint64_t frames = 0;
+    uint64_t draws = 0;
+    double wall = 0.0;
+    for (std::size_t r = 0; r < repeats; r++) {
+      qch_vm::machine m;
+      qch_vm::load_program(m, *program_data);
+      emu::seed_random(opts.seed.value_or(emu::default_seed));
+
+      // display updates go through the software frontend path
+      render::SoftRenderer renderer(1);
+      emu::InputPlayer input(script ? &*script : nullptr);
+      clock = {};
+      const uint64_t cycles = *seconds * emu::cycles_per_second;
+      frames = 0;
+      draws = 0;
+
+      timing::Clock wall_clock;
+      while (clock.cycles < cycles && !m.quit) {
+        input.apply(clock.cycles, m);
+        if (emu::step(m, clock)) {
+          frames++;
+        }
+        if (m.draw) {
+          renderer.upload(m);
+          m.draw = false;
+          draws++;
+        }
+      }
+      const double elapsed = wall_clock.get().count();
+      wall = r == 0 ? elapsed : std::min(wall, elapsed);
+    }
+
+    const double emulated =
+      static_cast<double>(clock.cycles) / emu::cycles_per_second;
+    const double speed = wall > 0.0 ? emulated / wall : 0.0;
+    const double ips = wall > 0.0 ? clock.instructions / wall : 0.0;
+    const long rss = peak_rss_kib();
+
+    const auto min_speed = parse_threshold(fields[3]);
+    const auto max_rss = parse_threshold(fields[4]);
+    const bool slow = min_speed && speed < *min_speed;
+    const bool large = max_rss && rss > *max_rss;
+    regressed |= !opts.update && (slow || large);
+
+    std::printf(
+      "%s    {\"rom\": \"%s\", \"script\": \"%s\", "
+      "\"emulated_seconds\": %.3f, \"wall_seconds\": %.6f, "
+      "\"speed\": %.1f, \"ips\": %.0f, \"frames\": %llu, \"draws\": %llu, "
+      "\"peak_rss_kib\": %ld, \"regressed\": %s}",
+      first ? "" : ",\n",
+      report::json_escape(fields[0]).c_str(),
+      report::json_escape(fields[1]).c_str(),
+      emulated, wall, speed, ips,
+      static_cast<unsigned long long>(frames),
+      static_cast<unsigned long long>(draws),
+      rss, (slow || large) ? "true" : "false"
+    );
+    first = false;
+
+    if (slow) {
+      std::cerr << fields[0] << ": speed " << speed << "x, below "
+        << *min_speed << "x\n";
+    }
+    if (large) {
+      std::cerr << fields[0] << ": peak rss " << rss << " KiB, above "
+        << *max_rss << " KiB\n";
+    }
+
+    if (opts.update) {
+      const long new_speed = std::floor(speed * speed_margin);
+      const long new_rss = std::ceil(rss * rss_margin);
+      fields[3] = std::to_string(new_speed);
+      fields[4] = std::to_string(new_rss);
+      lines[i].text = manifest::join(fields);
+    }
+  }
+
+  std::printf("\n  ]\n}\n");
+
+  if (opts.update) {
+    std::ofstream ofs(manifest_path);
+    ofs << manifest::to_string(lines);
+    return 0;
+  }
+
+  return regressed ? to_underlying(error_code_t::bench_regressed) : 0;
+}
+
+static std::optional<double> parse_threshold(const std::string &s) {
+  if (s == "-") { return {}; }
+
+  char *end = nullptr;
+  const double v = std::strtod(s.c_str(), &end);
+  if (end == s.c_str() || *end != '\0') { return {}; }
+
+  return v;
+}
+
+static void reset_peak_rss() {
+  // linux only, elsewhere the peak is the process peak so far
+  std::ofstream ofs("/proc/self/clear_refs");
+  ofs << "5";
+}
+
+static long peak_rss_kib() {
+  // VmHWM follows resets, ru_maxrss does not
+  std::ifstream ifs("/proc/self/status");
+  std::string line;
+  while (std::getline(ifs, line)) {
+    if (line.compare(0, 6, "VmHWM:") == 0) {
+      return std::strtol(line.c_str() + 6, nullptr, 10);
+    }
+  }
+
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  // kilobytes on linux
+  return usage.ru_maxrss;
+}
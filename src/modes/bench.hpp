@@ -0,0 +1,16 @@
+#ifndef __BENCH_HPP__
+#define __BENCH_HPP__
+
+#include "../util/async_log.hpp"
+#include "../util/options.hpp"
+
+namespace modes {
+  // times single opcodes through fetch/decode/execute and prints json
+  int run_opcode_bench(const options_t &opts);
+
+  // runs the roms listed in a bench manifest unthrottled for a fixed
+  // emulated duration, prints json and checks the stored thresholds
+  int run_rom_bench(const options_t &opts, logging::AsyncLog &log_stream);
+}
+
+#endif // __BENCH_HPP__
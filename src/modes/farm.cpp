@@ -0,0 +1,154 @@
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include <qxdg/qxdg.hpp>
+#include <qfio/qfio.hpp>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../emu/cycle.hpp"
+#include "../emu/input_script.hpp"
+#include "../emu/runner.hpp"
+#include "../emu/state.hpp"
+#include "../util/async_log.hpp"
+#include "../util/error.hpp"
+#include "../util/options.hpp"
+#include "../util/report.hpp"
+#include "../util/thread_pool.hpp"
+#include "../util/timer.hpp"
+#include "farm.hpp"
+
+static const std::regex program_re(R"re(.*(\.ch8)$)re");
+
+struct farm_task {
+  std::size_t rom;
+  std::optional<std::size_t> script;
+};
+
+struct farm_result {
+  bool loaded = false;
+  emu::run_result run;
+  uint64_t state_hash = 0;
+  uint64_t gfx_hash = 0;
+};
+
+int modes::run_farm(
+  const options_t &opts, const xdg::base &base_dirs,
+  logging::AsyncLog &log_stream
+) {
+  std::vector<std::string> roms;
+  if (opts.program_path) {
+    roms.push_back(*opts.program_path);
+  } else {
+    for (const auto &p : xdg::search_data_dirs(base_dirs, "qchip", program_re)) {
+      roms.push_back(p);
+    }
+  }
+
+  std::vector<emu::input_script> scripts;
+  for (const auto &path : opts.script_paths) {
+    auto text = fio::read(path);
+    auto script = text ? emu::parse_input_script(path, *text) : std::nullopt;
+    if (!script) {
+      std::cerr << "could not load input script: " << path << "\n";
+      return to_underlying(error_code_t::invalid_args);
+    }
+    scripts.push_back(*script);
+  }
+
+  std::vector<farm_task> tasks;
+  for (std::size_t r = 0; r < roms.size(); r++) {
+    if (scripts.empty()) {
+      tasks.push_back({r, {}});
+    }
+    for (std::size_t s = 0; s < scripts.size(); s++) {
+      tasks.push_back({r, s});
+    }
+  }
+
+  log_stream << "farm: " << tasks.size() << " tasks\n";
+
+  const emu::run_limits limits = {opts.cycles, timing::seconds(opts.timeout)};
+  std::vector<farm_result> results(tasks.size());
+
+  timing::Clock clock;
+  {
+    util::ThreadPool pool(opts.jobs);
+
+    for (std::size_t i = 0; i < tasks.size(); i++) {
+      pool.submit([&, i](const std::size_t){
+        const farm_task &task = tasks[i];
+        farm_result &result = results[i];
+
+        auto program_data = fio::readb(roms[task.rom]);
+        if (!program_data) { return; }
+
+        qch_vm::machine m;
+        qch_vm::load_program(m, *program_data);
+        emu::seed_random(opts.seed.value_or(emu::default_seed));
+        result.loaded = true;
+
+        const emu::input_script *script = task.script
+          ? &scripts[*task.script]
+          : nullptr;
+        result.run = emu::run(m, limits, script);
+        result.state_hash = emu::state_hash(m);
+        result.gfx_hash = emu::gfx_hash(m);
+      });
+    }
+
+    pool.wait();
+  }
+  const double elapsed = clock.get().count();
+
+  report::table table;
+  table.columns = {
+    "rom", "script", "status", "cycles", "instructions", "frames", "seconds",
+    "state_hash", "gfx_hash"
+  };
+  table.numeric = {false, false, false, true, true, true, true, false, false};
+
+  std::map<std::string, std::size_t> summary;
+  for (std::size_t i = 0; i < tasks.size(); i++) {
+    const farm_task &task = tasks[i];
+    const farm_result &result = results[i];
+
+    const std::string status = result.loaded
+      ? emu::to_string(result.run.status)
+      : "error";
+    summary[status]++;
+
+    table.rows.push_back({
+      roms[task.rom],
+      task.script ? scripts[*task.script].name : "",
+      status,
+      std::to_string(result.run.clock.cycles),
+      std::to_string(result.run.clock.instructions),
+      std::to_string(result.run.frames),
+      std::to_string(result.run.seconds),
+      emu::hash_string(result.state_hash),
+      emu::hash_string(result.gfx_hash)
+    });
+  }
+
+  if (opts.report_path) {
+    std::ofstream ofs(*opts.report_path);
+    report::write(ofs, table, opts.report_format);
+  } else {
+    report::write(std::cout, table, opts.report_format);
+  }
+
+  std::cerr << tasks.size() << " tasks in " << elapsed << "s\n";
+  for (const auto &[status, count] : summary) {
+    std::cerr << "  " << status << ": " << count << "\n";
+  }
+
+  return 0;
+}
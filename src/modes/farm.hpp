@@ -0,0 +1,18 @@
+#ifndef __FARM_HPP__
+#define __FARM_HPP__
+
+#include <qxdg/qxdg.hpp>
+
+#include "../util/async_log.hpp"
+#include "../util/options.hpp"
+
+namespace modes {
+  // runs every rom (x every input script) headless across all cores and
+  // writes one merged csv/json report
+  int run_farm(
+    const options_t &opts, const xdg::base &base_dirs,
+    logging::AsyncLog &log_stream
+  );
+}
+
+#endif // __FARM_HPP__
@@ -0,0 +1,319 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <regex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <qxdg/qxdg.hpp>
+#include <qfio/qfio.hpp>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../emu/cycle.hpp"
+#include "../emu/state.hpp"
+#include "../fuzz/coverage.hpp"
+#include "../fuzz/mutator.hpp"
+#include "../util/async_log.hpp"
+#include "../util/error.hpp"
+#include "../util/options.hpp"
+#include "../util/thread_pool.hpp"
+#include "../util/timer.hpp"
+#include "fuzz.hpp"
+
+namespace fs = std::filesystem;
+
+static const std::regex program_re(R"re(.*(\.ch8)$)re");
+
+// a run longer than this is treated as a hang when --timeout is not given
+static constexpr double default_hang_seconds = 1.0;
+
+// one in this many inputs is generated from scratch instead of mutated
+static constexpr std::size_t generate_ratio = 16;
+
+// per worker state read by the watchdog, padded to avoid false sharing
+struct alignas(64) worker_slot {
+  std::atomic<uint64_t> execs{0};
+  std::atomic<int64_t> started{0}; // steady clock ns, 0 while idle
+  const std::vector<uint8_t> *input = nullptr;
+};
+
+class Corpus {
+public:
+  void add(std::vector<uint8_t> input) {
+    std::unique_lock lock(mutex);
+    inputs.push_back(std::move(input));
+  }
+
+  // copies two random entries, returns false when the corpus is empty
+  bool pick(
+    fuzz::Rng &rng, std::vector<uint8_t> &input, std::vector<uint8_t> &other
+  ) const {
+    std::shared_lock lock(mutex);
+    if (inputs.empty()) { return false; }
+    input = inputs[rng.below(inputs.size())];
+    other = inputs[rng.below(inputs.size())];
+    return true;
+  }
+
+  std::size_t size() const {
+    std::shared_lock lock(mutex);
+    return inputs.size();
+  }
+private:
+  mutable std::shared_mutex mutex;
+  std::vector<std::vector<uint8_t>> inputs;
+};
+
+// crash reporting, only async signal safe calls are made from the handler
+static thread_local const std::vector<uint8_t> *crash_input = nullptr;
+static thread_local char crash_path[512];
+
+static void on_crash(const int sig) {
+  if (crash_input != nullptr) {
+    const int fd = open(crash_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+      ssize_t written = write(fd, crash_input->data(), crash_input->size());
+      (void)written;
+      close(fd);
+    }
+    static const char msg[] = "fuzz: vm crashed, input saved to crashes/\n";
+    ssize_t written = write(STDERR_FILENO, msg, sizeof(msg) - 1);
+    (void)written;
+  }
+
+  std::signal(sig, SIG_DFL);
+  std::raise(sig);
+}
+
+static void install_crash_handler() {
+  struct sigaction action = {};
+  action.sa_handler = on_crash;
+  sigemptyset(&action.sa_mask);
+  for (const int sig : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT}) {
+    sigaction(sig, &action, nullptr);
+  }
+}
+
+static int64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    timing::clock::now().time_since_epoch()
+  ).count();
+}
+
+static bool save(const fs::path &path, const std::vector<uint8_t> &data) {
+  std::ofstream ofs(path, std::ios::binary);
+  ofs.write(reinterpret_cast<const char *>(data.data()), data.size());
+  return ofs.good();
+}
+
+// resets `m` by copying the saved state fields of the template, one memcpy
+// each, so no constructor, font load or allocation runs per execution
+static void reset(
+  qch_vm::machine &m, const qch_vm::machine &tmpl,
+  const std::vector<uint8_t> &input
+) {
+  emu::copy_state(m, tmpl);
+  emu::write_program(m, input);
+}
+
+// runs one input within `cycles`, recording every executed pc and opcode
+// keys and CXNN values come from sequences seeded by the input so runs
+// reproduce from the saved file alone
+static void execute(
+  qch_vm::machine &m, const uint64_t cycles, const std::vector<uint8_t> &input,
+  fuzz::local_coverage &coverage
+) {
+  uint64_t keys = emu::hash_bytes(input.data(), input.size());
+  emu::seed_random(keys);
+  emu::virtual_clock clock;
+
+  while (clock.cycles < cycles && !m.quit && !m.halted) {
+    if (!m.blocking) {
+      if (emu::is_self_jump(m)) { break; }
+      coverage.add(m.pc, emu::peek_opcode(m));
+    }
+
+    if (emu::step(m, clock)) {
+      keys = keys * 6364136223846793005 + 1442695040888963407;
+      const std::size_t pressed = keys >> 60;
+      for (std::size_t k = 0; k < m.keys.size(); k++) {
+        m.keys[k] = (k == pressed) && (keys & 0x100);
+      }
+    }
+  }
+}
+
+int modes::run_fuzz(
+  const options_t &opts, const xdg::base &base_dirs,
+  logging::AsyncLog &log_stream
+) {
+  const fs::path out_dir = *opts.fuzz_dir;
+  std::error_code ec;
+  for (const char *sub : {"queue", "crashes", "hangs"}) {
+    fs::create_directories(out_dir / sub, ec);
+    if (ec) {
+      std::cerr << "could not create " << (out_dir / sub) << "\n";
+      return to_underlying(error_code_t::invalid_args);
+    }
+  }
+
+  // seeds: the given program or every installed one, plus an earlier queue
+  std::vector<std::string> seed_paths;
+  if (opts.program_path) {
+    seed_paths.push_back(*opts.program_path);
+  } else {
+    for (const auto &p : xdg::search_data_dirs(base_dirs, "qchip", program_re)) {
+      seed_paths.push_back(p);
+    }
+  }
+  for (const auto &entry : fs::directory_iterator(out_dir / "queue", ec)) {
+    seed_paths.push_back(entry.path().string());
+  }
+
+  // the template holds the font and nothing else, seeds are replayed to
+  // fill the coverage map before mutation starts
+  qch_vm::machine tmpl;
+  qch_vm::load_program(tmpl, {});
+
+  fuzz::CoverageMap coverage;
+  Corpus corpus;
+  {
+    qch_vm::machine m;
+    fuzz::local_coverage local;
+    for (const auto &path : seed_paths) {
+      auto data = fio::readb(path);
+      if (!data || data->empty()) { continue; }
+      data->resize(std::min(data->size(), fuzz::max_program_size));
+
+      local.clear();
+      reset(m, tmpl, *data);
+      execute(m, opts.fuzz_cycles, *data, local);
+      coverage.merge(local);
+      corpus.add(std::move(*data));
+    }
+  }
+
+  log_stream << "fuzz: " << corpus.size() << " seeds, output in "
+    << out_dir.string() << "\n";
+
+  install_crash_handler();
+
+  util::ThreadPool pool(opts.jobs);
+  std::vector<worker_slot> slots(pool.size());
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> saved{0};
+
+  for (std::size_t w = 0; w < pool.size(); w++) {
+    pool.submit([&, w](const std::size_t){
+      worker_slot &slot = slots[w];
+      fuzz::Rng rng(
+        opts.seed.value_or(emu::default_seed) * 0x9e3779b97f4a7c15 + w + 1
+      );
+      qch_vm::machine m;
+      fuzz::local_coverage local;
+      std::vector<uint8_t> input;
+      std::vector<uint8_t> other;
+
+      std::snprintf(
+        crash_path, sizeof(crash_path), "%s/crash_%zu",
+        (out_dir / "crashes").c_str(), w
+      );
+      crash_input = &input;
+      slot.input = &input;
+
+      while (!stop.load(std::memory_order_relaxed)) {
+        if (rng.below(generate_ratio) == 0 || !corpus.pick(rng, input, other)) {
+          fuzz::generate(rng, input);
+        } else {
+          fuzz::mutate(rng, input, other);
+        }
+
+        local.clear();
+        slot.started.store(now_ns(), std::memory_order_release);
+        reset(m, tmpl, input);
+        execute(m, opts.fuzz_cycles, input, local);
+        slot.started.store(0, std::memory_order_relaxed);
+        slot.execs.fetch_add(1, std::memory_order_relaxed);
+
+        if (coverage.merge(local)) {
+          char name[32];
+          std::snprintf(name, sizeof(name), "id_%06llu.ch8",
+            static_cast<unsigned long long>(saved.fetch_add(1)));
+          save(out_dir / "queue" / name, input);
+          corpus.add(input);
+        }
+      }
+
+      crash_input = nullptr;
+    });
+  }
+
+  // the main thread reports progress and watches for runs that never end
+  const double hang_seconds = opts.timeout > 0.0
+    ? opts.timeout
+    : default_hang_seconds;
+  timing::Clock clock;
+  double last_report = 0.0;
+  uint64_t execs = 0;
+
+  while (true) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const double elapsed = clock.get().count();
+
+    execs = 0;
+    for (const auto &slot : slots) {
+      execs += slot.execs.load(std::memory_order_relaxed);
+    }
+
+    const int64_t now = now_ns();
+    for (std::size_t w = 0; w < slots.size(); w++) {
+      const int64_t started = slots[w].started.load(std::memory_order_acquire);
+      if (started == 0 || (now - started) * 1e-9 < hang_seconds) { continue; }
+
+      // a worker stuck inside the vm cannot be stopped, so save and exit
+      const fs::path path = out_dir / "hangs" / ("hang_" + std::to_string(w));
+      save(path, *slots[w].input);
+      std::cerr << "fuzz: run exceeded " << hang_seconds << "s, input saved to "
+        << path.string() << "\n";
+      std::fflush(nullptr);
+      std::_Exit(to_underlying(error_code_t::fuzz_hang));
+    }
+
+    if (elapsed - last_report >= 1.0) {
+      last_report = elapsed;
+      std::cerr << "fuzz: " << execs << " execs ("
+        << static_cast<uint64_t>(execs / elapsed) << "/s), corpus "
+        << corpus.size() << ", pcs " << coverage.pcs() << ", opcodes "
+        << coverage.opcodes() << "\n";
+    }
+
+    if ((opts.fuzz_execs != 0 && execs >= opts.fuzz_execs)
+      || (opts.fuzz_seconds > 0.0 && elapsed >= opts.fuzz_seconds)) {
+      break;
+    }
+  }
+
+  stop = true;
+  pool.wait();
+
+  std::cerr << "fuzz: " << execs << " execs in " << clock.get().count()
+    << "s, " << saved << " new inputs in " << (out_dir / "queue").string()
+    << "\n";
+
+  return 0;
+}
@@ -0,0 +1,18 @@
+#ifndef __FUZZ_HPP__
+#define __FUZZ_HPP__
+
+#include <qxdg/qxdg.hpp>
+
+#include "../util/async_log.hpp"
+#include "../util/options.hpp"
+
+namespace modes {
+  // mutates and generates programs on every core, keeping the ones that reach
+  // new pcs or opcodes and saving any that crash or hang the vm
+  int run_fuzz(
+    const options_t &opts, const xdg::base &base_dirs,
+    logging::AsyncLog &log_stream
+  );
+}
+
+#endif // __FUZZ_HPP__
@@ -0,0 +1,291 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <vector>
+
+#include <qfio/qfio.hpp>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../capture/frame_writer.hpp"
+#include "../control/server.hpp"
+#include "../emu/batch.hpp"
+#include "../emu/cycle.hpp"
+#include "../emu/input_script.hpp"
+#include "../emu/movie.hpp"
+#include "../emu/profiler.hpp"
+#include "../emu/seek.hpp"
+#include "../emu/state.hpp"
+#include "../emu/trace.hpp"
+#include "../util/async_log.hpp"
+#include "../util/error.hpp"
+#include "../util/options.hpp"
+#include "../util/timer.hpp"
+#include "headless.hpp"
+
+// lane `lane` holds one key for 8 frames, then releases it for 8; keys only
+// change on multiples of 8 frames
+static void lane_keys(
+  const uint64_t frame, const std::size_t lane, bool (&keys)[16]
+) {
+  const uint64_t phase = frame / 8;
+  for (std::size_t k = 0; k < 16; k++) {
+    keys[k] = (phase & 1) && k == (phase / 2 + lane) % 16;
+  }
+}
+
+// runs `opts.lanes` copies in one emu::Batch, then every lane again on its
+// own machine and compares the final states
+static int run_lanes(
+  const options_t &opts, const std::vector<uint8_t> &program
+) {
+  const uint64_t seed = opts.seed.value_or(emu::default_seed);
+  emu::seed_random(seed);
+  emu::Batch batch(program, opts.lanes);
+  bool keys[16];
+  uint64_t frame = 0;
+
+  timing::Clock wall_clock;
+  const timing::seconds start = wall_clock.get();
+
+  while (batch.clock().cycles < opts.cycles) {
+    if (batch.step() && ++frame % 8 == 0) {
+      for (std::size_t l = 0; l < batch.size(); l++) {
+        lane_keys(frame, l, keys);
+        for (uint8_t k = 0; k < 16; k++) {
+          batch.set_key(l, k, keys[k]);
+        }
+      }
+    }
+  }
+
+  const double elapsed = (wall_clock.get() - start).count();
+  const timing::seconds scalar_start = wall_clock.get();
+
+  // every lane draws CXNN values from its own source with the same seed
+  std::size_t mismatches = 0;
+  for (std::size_t l = 0; l < batch.size(); l++) {
+    qch_vm::machine m;
+    qch_vm::load_program(m, program);
+    emu::seed_random(seed);
+    emu::virtual_clock clock;
+    uint64_t lane_frame = 0;
+
+    while (clock.cycles < opts.cycles && !m.quit) {
+      if (emu::step(m, clock) && ++lane_frame % 8 == 0) {
+        lane_keys(lane_frame, l, keys);
+        for (uint8_t k = 0; k < 16; k++) {
+          m.keys[k] = keys[k];
+        }
+      }
+    }
+
+    if (emu::state_hash(m) != emu::state_hash(batch.machine(l))) {
+      std::fprintf(stderr, "lane %zu differs from a single machine run\n", l);
+      mismatches++;
+    }
+  }
+
+  const double scalar_elapsed = (wall_clock.get() - scalar_start).count();
+  const double lane_cycles = static_cast<double>(batch.clock().cycles)
+    * batch.size();
+  const double shared = batch.vector_cycles()
+    + batch.scalar_cycles() > 0
+      ? 100.0 * batch.vector_cycles()
+        / (batch.vector_cycles() + batch.scalar_cycles())
+      : 0.0;
+
+  std::printf("lanes: %zu\n", batch.size());
+  std::printf(
+    "cycles: %llu\n", static_cast<unsigned long long>(batch.clock().cycles)
+  );
+  std::printf("seconds: %.6f\n", elapsed);
+  std::printf("lane cycles/s: %.0f\n", elapsed > 0.0 ? lane_cycles / elapsed : 0.0);
+  std::printf("shared: %.1f%%\n", shared);
+  std::printf("single machine seconds: %.6f\n", scalar_elapsed);
+  std::printf("mismatches: %zu\n", mismatches);
+  std::printf(
+    "hash: %s\n", emu::hash_string(emu::state_hash(batch.machine(0))).c_str()
+  );
+
+  return mismatches == 0 ? 0 : to_underlying(error_code_t::batch_mismatch);
+}
+
+// the machine only runs when a client steps it, serves until the last client
+// disconnects
+static int run_control(const options_t &opts, qch_vm::machine &m) {
+  control::Server server(*opts.control_path);
+  if (!server.good()) {
+    std::fprintf(stderr, "could not listen on %s\n", opts.control_path->c_str());
+    return to_underlying(error_code_t::invalid_args);
+  }
+
+  emu::seed_random(opts.seed.value_or(emu::default_seed));
+  emu::virtual_clock clock;
+  bool served = false;
+
+  while (!served || server.connected()) {
+    server.service(m, clock, -1);
+    served = served || server.connected();
+  }
+
+  return 0;
+}
+
+// jumps to every requested frame in the given order, each from the closest
+// keyframe the earlier seeks left behind
+static int run_seeks(
+  const options_t &opts, const qch_vm::machine &start,
+  const emu::input_script *script, const uint64_t seed
+) {
+  emu::Seeker seeker(start, script, seed);
+  qch_vm::machine m;
+  emu::virtual_clock clock;
+  emu::InputPlayer input(script);
+  timing::Clock wall_clock;
+
+  for (const uint64_t frame : opts.seek_frames) {
+    const timing::seconds seek_start = wall_clock.get();
+    const bool reached = seeker.seek(frame, m, clock, input);
+    const double elapsed = (wall_clock.get() - seek_start).count();
+
+    if (reached) {
+      std::printf(
+        "frame %llu: %s, %.6f seconds\n", static_cast<unsigned long long>(frame),
+        emu::hash_string(emu::state_hash(m)).c_str(), elapsed
+      );
+    } else {
+      std::printf(
+        "frame %llu: program quit at frame %llu\n",
+        static_cast<unsigned long long>(frame),
+        static_cast<unsigned long long>(clock.frames)
+      );
+    }
+  }
+
+  std::printf("keyframes: %zu\n", seeker.keyframes());
+  std::printf("keyframe bytes: %zu\n", seeker.bytes());
+  return 0;
+}
+
+int modes::run_headless(const options_t &opts, logging::AsyncLog &log_stream) {
+  auto program_data = fio::readb(*opts.program_path);
+  if (!program_data) {
+    log_stream << "could not read file";
+    return to_underlying(error_code_t::invalid_args);
+  }
+  log_stream << "headless run ...\n--> " << *opts.program_path << "\n";
+
+  if (opts.lanes > 1) {
+    return run_lanes(opts, *program_data);
+  }
+
+  qch_vm::machine m;
+  qch_vm::load_program(m, *program_data);
+
+  if (opts.control_path) {
+    return run_control(opts, m);
+  }
+
+  // a movie replaces the cycle budget and seed with the recorded ones
+  std::optional<emu::movie> movie;
+  if (opts.replay_path) {
+    movie = emu::read_movie(*opts.replay_path);
+    if (!movie) {
+      std::fprintf(stderr, "could not read movie: %s\n", opts.replay_path->c_str());
+      return to_underlying(error_code_t::invalid_args);
+    }
+    if (movie->header.program_hash
+      != emu::hash_bytes(program_data->data(), program_data->size())) {
+      std::fprintf(stderr, "movie was recorded with a different program\n");
+      return to_underlying(error_code_t::invalid_args);
+    }
+    if (movie->header.cycles_per_second != emu::cycles_per_second
+      || movie->header.timer_frequency != emu::timer_frequency) {
+      std::fprintf(stderr, "movie was recorded with different timing\n");
+    }
+  }
+
+  const uint64_t seed = movie
+    ? movie->header.seed
+    : opts.seed.value_or(emu::default_seed);
+  if (!opts.seek_frames.empty()) {
+    return run_seeks(opts, m, movie ? &movie->inputs : nullptr, seed);
+  }
+
+  emu::seed_random(seed);
+  const uint64_t cycles = (movie && movie->end_cycle)
+    ? *movie->end_cycle
+    : opts.cycles;
+  emu::InputPlayer input(movie ? &movie->inputs : nullptr);
+
+  std::optional<emu::Profiler> profiler;
+  if (opts.profile_prefix) {
+    profiler.emplace();
+  }
+
+  std::optional<emu::TraceRing> trace;
+  if (opts.trace_path) {
+    trace.emplace(opts.trace_size);
+    emu::trace_to(&*trace);
+  }
+
+  std::optional<capture::FrameWriter> frame_writer;
+  if (opts.capture_path) {
+    frame_writer.emplace(
+      *opts.capture_path, opts.capture_format, opts.capture_scale
+    );
+    if (!frame_writer->good()) {
+      std::fprintf(stderr, "could not open capture output %s\n", opts.capture_path->c_str());
+      return to_underlying(error_code_t::invalid_args);
+    }
+  }
+
+  emu::virtual_clock clock;
+  timing::Clock wall_clock;
+  const timing::seconds start = wall_clock.get();
+
+  while (clock.cycles < cycles && !m.quit) {
+    input.apply(clock.cycles, m);
+    if (profiler) {
+      profiler->record(m);
+    }
+    if (emu::step(m, clock) && frame_writer) {
+      frame_writer->push(m);
+    }
+  }
+
+  const double elapsed = (wall_clock.get() - start).count();
+  const double ips = elapsed > 0.0 ? clock.instructions / elapsed : 0.0;
+
+  std::printf("cycles: %llu\n", static_cast<unsigned long long>(clock.cycles));
+  std::printf(
+    "instructions: %llu\n", static_cast<unsigned long long>(clock.instructions)
+  );
+  std::printf("seconds: %.6f\n", elapsed);
+  std::printf("ips: %.0f\n", ips);
+  std::printf("hash: %s\n", emu::hash_string(emu::state_hash(m)).c_str());
+
+  if (profiler && !profiler->write(*opts.profile_prefix, m)) {
+    std::fprintf(stderr, "could not write profile %s\n", opts.profile_prefix->c_str());
+  }
+
+  if (trace) {
+    emu::trace_to(nullptr);
+    if (!trace->write(*opts.trace_path)) {
+      std::fprintf(stderr, "could not write trace %s\n", opts.trace_path->c_str());
+    }
+  }
+
+  if (movie && movie->end_cycle) {
+    const bool match = emu::state_hash(m) == movie->end_hash;
+    std::printf("replay: %s\n", match ? "match" : "mismatch");
+    if (!match) {
+      return to_underlying(error_code_t::replay_mismatch);
+    }
+  }
+
+  return 0;
+}
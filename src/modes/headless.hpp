@@ -0,0 +1,13 @@
+#ifndef __HEADLESS_HPP__
+#define __HEADLESS_HPP__
+
+#include "../util/async_log.hpp"
+#include "../util/options.hpp"
+
+namespace modes {
+  // runs `opts.cycles` cycles unthrottled with no display or input, then
+  // prints run statistics and the final state hash to stdout
+  int run_headless(const options_t &opts, logging::AsyncLog &log_stream);
+}
+
+#endif // __HEADLESS_HPP__
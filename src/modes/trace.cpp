@@ -0,0 +1,28 @@
+#include <cstdio>
+#include <string>
+
+#include "../emu/trace.hpp"
+#include "../util/error.hpp"
+#include "../util/options.hpp"
+#include "trace.hpp"
+
+int modes::run_decode_trace(const options_t &opts) {
+  emu::trace_header header;
+  const auto records = emu::read_trace(*opts.decode_trace_path, header);
+  if (!records) {
+    std::fprintf(
+      stderr, "could not read trace %s\n", opts.decode_trace_path->c_str()
+    );
+    return to_underlying(error_code_t::invalid_args);
+  }
+
+  std::printf(
+    "# %llu instructions traced, last %llu shown\n"
+    "#      cycle  pc   op    class changed\n",
+    static_cast<unsigned long long>(header.total),
+    static_cast<unsigned long long>(header.count)
+  );
+  std::fputs(emu::trace_text(*records).c_str(), stdout);
+
+  return 0;
+}
@@ -0,0 +1,11 @@
+#ifndef __MODES_TRACE_HPP__
+#define __MODES_TRACE_HPP__
+
+#include "../util/options.hpp"
+
+namespace modes {
+  // prints the trace file written by --trace as text on stdout
+  int run_decode_trace(const options_t &opts);
+}
+
+#endif // __MODES_TRACE_HPP__
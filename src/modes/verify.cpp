@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <qfio/qfio.hpp>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../emu/cycle.hpp"
+#include "../emu/input_script.hpp"
+#include "../emu/state.hpp"
+#include "../util/async_log.hpp"
+#include "../util/error.hpp"
+#include "../util/image.hpp"
+#include "../util/manifest.hpp"
+#include "../util/options.hpp"
+#include "../util/thread_pool.hpp"
+#include "verify.hpp"
+
+namespace fs = std::filesystem;
+
+struct checkpoint {
+  std::size_t line;
+  std::string rom;
+  std::string script;
+  uint64_t cycles;
+  std::optional<uint64_t> hash;
+
+  // filled in by the run
+  uint64_t actual = 0;
+  image::bitmap frame;
+};
+
+static std::optional<uint64_t> parse_hash(const std::string &s);
+static std::string frame_name(const checkpoint &c);
+static std::string format_line(const checkpoint &c);
+static void write_diff(
+  const std::string &path, const image::bitmap &expected,
+  const image::bitmap &actual
+);
+
+int modes::run_verify(const options_t &opts, logging::AsyncLog &log_stream) {
+  const fs::path manifest_path = *opts.verify_path;
+  const fs::path base = manifest_path.parent_path();
+
+  auto manifest = fio::read(manifest_path.string());
+  if (!manifest) {
+    std::cerr << "could not read manifest: " << manifest_path << "\n";
+    return to_underlying(error_code_t::invalid_args);
+  }
+  log_stream << "verifying against " << manifest_path.string() << "\n";
+
+  // <rom> <script | -> <cycles> <framebuffer hash | ->
+  auto lines = manifest::parse(*manifest);
+  std::vector<checkpoint> checkpoints;
+  for (std::size_t i = 0; i < lines.size(); i++) {
+    const auto &fields = lines[i].fields;
+    if (fields.empty()) { continue; }
+
+    const auto cycles = fields.size() == 4
+      ? parse_size(fields[2])
+      : std::nullopt;
+    if (!cycles) {
+      std::cerr << "malformed manifest line " << (i + 1) << "\n";
+      return to_underlying(error_code_t::invalid_args);
+    }
+
+    checkpoint c;
+    c.line = i;
+    c.rom = fields[0];
+    c.script = fields[1];
+    c.cycles = *cycles;
+    c.hash = parse_hash(fields[3]);
+    checkpoints.push_back(c);
+  }
+
+  // one run per rom/script pair, stopping at each of its checkpoints
+  std::map<std::pair<std::string, std::string>, std::vector<checkpoint *>> runs;
+  for (auto &c : checkpoints) {
+    runs[{c.rom, c.script}].push_back(&c);
+  }
+
+  std::atomic<bool> load_failed = false;
+  {
+    util::ThreadPool pool(opts.jobs);
+
+    for (auto &[key, stops] : runs) {
+      std::sort(stops.begin(), stops.end(), [](auto a, auto b){
+        return a->cycles < b->cycles;
+      });
+
+      pool.submit([&, &stops = stops](const std::size_t){
+        const std::string &rom = stops.front()->rom;
+        const std::string &script_path = stops.front()->script;
+
+        auto program_data = fio::readb((base / rom).string());
+        std::optional<emu::input_script> script;
+        if (script_path != "-") {
+          auto text = fio::read((base / script_path).string());
+          if (text) { script = emu::parse_input_script(script_path, *text); }
+          if (!script) { load_failed = true; return; }
+        }
+        if (!program_data) { load_failed = true; return; }
+
+        qch_vm::machine m;
+        qch_vm::load_program(m, *program_data);
+        emu::seed_random(opts.seed.value_or(emu::default_seed));
+
+        emu::virtual_clock clock;
+        emu::InputPlayer input(script ? &*script : nullptr);
+        for (checkpoint *c : stops) {
+          while (clock.cycles < c->cycles) {
+            input.apply(clock.cycles, m);
+            emu::step(m, clock);
+          }
+
+          c->actual = emu::gfx_hash(m);
+          c->frame.width = m.display_width;
+          c->frame.height = m.display_height;
+          c->frame.pixels.assign(m.gfx.begin(), m.gfx.end());
+        }
+      });
+    }
+
+    pool.wait();
+  }
+
+  if (load_failed) {
+    std::cerr << "could not load every rom and script in the manifest\n";
+    return to_underlying(error_code_t::invalid_args);
+  }
+
+  // reference frames are committed, diffs of failed checkpoints are not
+  const fs::path frame_dir = base / "frames";
+  const fs::path diff_dir = base / "diffs";
+  std::size_t failures = 0;
+  for (auto &c : checkpoints) {
+    const std::string name = frame_name(c);
+
+    if (opts.update) {
+      const bool changed = c.hash != c.actual;
+      c.hash = c.actual;
+      if (changed) {
+        std::cout << "UPDATE " << format_line(c) << "\n";
+      }
+      fs::create_directories(frame_dir);
+      image::write_pbm((frame_dir / (name + ".pbm")).string(), c.frame);
+      lines[c.line].text = format_line(c);
+      continue;
+    }
+
+    if (!c.hash) {
+      std::cout << "MISSING " << format_line(c) << "\n";
+      failures++;
+    } else if (*c.hash != c.actual) {
+      fs::create_directories(diff_dir);
+      const std::string diff_path = (diff_dir / (name + ".diff.png")).string();
+      auto expected = image::read_pbm((frame_dir / (name + ".pbm")).string());
+      write_diff(diff_path, expected ? *expected : image::bitmap(), c.frame);
+
+      std::cout << "FAIL " << c.rom << " " << c.script << " " << c.cycles
+        << " expected " << emu::hash_string(*c.hash)
+        << " got " << emu::hash_string(c.actual)
+        << " (" << diff_path << ")\n";
+      failures++;
+    } else {
+      std::cout << "PASS " << c.rom << " " << c.script << " " << c.cycles << "\n";
+    }
+  }
+
+  if (opts.update) {
+    std::ofstream ofs(manifest_path);
+    ofs << manifest::to_string(lines);
+    return 0;
+  }
+
+  std::cout << (checkpoints.size() - failures) << "/" << checkpoints.size()
+    << " checkpoints match\n";
+
+  return failures ? to_underlying(error_code_t::verify_failed) : 0;
+}
+
+static std::optional<uint64_t> parse_hash(const std::string &s) {
+  if (s.size() != 16
+    || s.find_first_not_of("0123456789abcdef") != std::string::npos) {
+    return {};
+  }
+
+  return std::stoull(s, nullptr, 16);
+}
+
+static std::string frame_name(const checkpoint &c) {
+  std::string script = "none";
+  if (c.script != "-") {
+    script = fs::path(c.script).stem().string();
+  }
+
+  return fs::path(c.rom).stem().string() + "_" + script + "_"
+    + std::to_string(c.cycles);
+}
+
+static std::string format_line(const checkpoint &c) {
+  return c.rom + " " + c.script + " " + std::to_string(c.cycles) + " "
+    + (c.hash ? emu::hash_string(*c.hash) : "-");
+}
+
+// white = set in both, red = only expected, green = only actual
+static void write_diff(
+  const std::string &path, const image::bitmap &expected,
+  const image::bitmap &actual
+) {
+  const std::size_t size = actual.width * actual.height;
+  const bool comparable = expected.pixels.size() == size;
+
+  std::vector<uint8_t> rgba(size * 4, 0);
+  for (std::size_t i = 0; i < size; i++) {
+    const bool e = comparable && expected.pixels[i];
+    const bool a = actual.pixels[i];
+    uint8_t *p = rgba.data() + (i * 4);
+    p[0] = e ? 255 : 0;
+    p[1] = a ? 255 : 0;
+    p[2] = (e && a) ? 255 : 0;
+    p[3] = 255;
+  }
+
+  image::write_png(path, actual.width, actual.height, rgba.data());
+}
@@ -0,0 +1,13 @@
+#ifndef __VERIFY_HPP__
+#define __VERIFY_HPP__
+
+#include "../util/async_log.hpp"
+#include "../util/options.hpp"
+
+namespace modes {
+  // replays the runs listed in a golden manifest and compares framebuffer
+  // hashes at each checkpoint, see golden/manifest.txt for the format
+  int run_verify(const options_t &opts, logging::AsyncLog &log_stream);
+}
+
+#endif // __VERIFY_HPP__
@@ -0,0 +1,91 @@
+#ifndef HEADLESS
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <qxdg/qxdg.hpp>
+#include <qfio/qfio.hpp>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../emu/cycle.hpp"
+#include "../render/gl_wall_renderer.hpp"
+#include "../util/async_log.hpp"
+#include "../util/error.hpp"
+#include "../util/options.hpp"
+#include "../util/timer.hpp"
+#include "wall.hpp"
+
+constexpr timing::seconds loop_timestep(1.0/emu::cycles_per_second);
+constexpr timing::seconds timer_timestep(1.0/emu::timer_frequency);
+
+int modes::run_wall(
+  const options_t &opts, const xdg::base &base_dirs,
+  logging::AsyncLog &log_stream, const std::string &program_path
+) {
+  render::GLWallRenderer renderer;
+  if (auto error = renderer.init(base_dirs, log_stream, opts.instances)) {
+    return to_underlying(*error);
+  }
+
+  auto program_data = fio::readb(program_path);
+  if (!program_data) {
+    log_stream << "could not read file";
+    return to_underlying(error_code_t::invalid_args);
+  }
+  log_stream << "loading program into " << opts.instances << " machines\n";
+  log_stream << "--> " << program_path << "\n";
+
+  std::vector<qch_vm::machine> machines(opts.instances);
+  for (auto &m : machines) {
+    qch_vm::load_program(m, *program_data);
+    m.draw = true;
+  }
+
+  timing::Clock clock;
+  timing::Timer loop_timer;
+  timing::seconds loop_accumulator(0.0);
+  timing::seconds timer_accumulator(0.0);
+
+  while (!renderer.shouldClose()) {
+    loop_accumulator += loop_timer.getDelta();
+    timer_accumulator += loop_timer.getDelta();
+    loop_timer.tick(clock.get());
+
+    renderer.processInput(machines);
+
+    std::size_t steps = 0;
+    while (loop_accumulator >= loop_timestep) {
+      loop_accumulator -= loop_timestep;
+      steps++;
+    }
+    std::size_t ticks = 0;
+    while (timer_accumulator >= timer_timestep) {
+      timer_accumulator -= timer_timestep;
+      ticks++;
+    }
+
+    // run each machine for the whole slice so its state stays in cache
+    for (std::size_t i = 0; i < machines.size(); i++) {
+      qch_vm::machine &m = machines[i];
+      if (m.quit) { continue; }
+
+      for (std::size_t s = 0; s < steps; s++) {
+        emu::cycle(m);
+      }
+      for (std::size_t t = 0; t < ticks; t++) {
+        emu::tick_timers(m);
+      }
+
+      if (m.draw) {
+        renderer.upload(i, m);
+        m.draw = false;
+      }
+    }
+
+    renderer.draw();
+  }
+
+  return 0;
+}
+#endif
@@ -0,0 +1,18 @@
+#ifndef __WALL_HPP__
+#define __WALL_HPP__
+#include <string>
+
+#include <qxdg/qxdg.hpp>
+
+#include "../util/async_log.hpp"
+#include "../util/options.hpp"
+
+namespace modes {
+  // runs `opts.instances` copies of a program in one window
+  int run_wall(
+    const options_t &opts, const xdg::base &base_dirs,
+    logging::AsyncLog &log_stream, const std::string &program_path
+  );
+}
+
+#endif // __WALL_HPP__
@@ -0,0 +1,147 @@
+#include <array>
+#include <clocale>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+#include <curses.h>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../util/error.hpp"
+#include "../util/timer.hpp"
+#include "curses_renderer.hpp"
+
+static const std::map<int, uint8_t> key_map = {
+  {'x', 0x0},
+  {'1', 0x1},
+  {'2', 0x2},
+  {'3', 0x3},
+  {'q', 0x4},
+  {'w', 0x5},
+  {'e', 0x6},
+  {'a', 0x7},
+  {'s', 0x8},
+  {'d', 0x9},
+  {'z', 0xa},
+  {'c', 0xb},
+  {'4', 0xc},
+  {'r', 0xd},
+  {'f', 0xe},
+  {'v', 0xf}
+};
+
+static const std::map<int, render::hotkey_t> hotkey_map = {
+  {KEY_F(5), render::hotkey_t::save_state},
+  {KEY_F(6), render::hotkey_t::opcode_stats},
+  {KEY_F(9), render::hotkey_t::load_state},
+  {KEY_BACKSPACE, render::hotkey_t::rewind},
+  {127, render::hotkey_t::rewind},
+  {KEY_PPAGE, render::hotkey_t::seek_back},
+  {KEY_NPAGE, render::hotkey_t::seek_forward}
+};
+
+// indexed by cell state
+static const char *glyphs[4] = {" ", "▀", "▄", "█"};
+
+static constexpr int key_escape = 27;
+
+// covers the initial autorepeat delay of most terminals
+static constexpr timing::seconds key_hold(0.5);
+
+render::CursesRenderer::CursesRenderer() {
+  std::setlocale(LC_ALL, "");
+  ESCDELAY = 25;
+
+  initscr();
+  cbreak();
+  noecho();
+  nodelay(stdscr, true);
+  keypad(stdscr, true);
+  curs_set(0);
+
+  if (has_colors()) {
+    start_color();
+    use_default_colors();
+    init_pair(1, COLOR_GREEN, -1);
+    attron(COLOR_PAIR(1));
+  }
+}
+
+render::CursesRenderer::~CursesRenderer() {
+  endwin();
+}
+
+void render::CursesRenderer::upload(const qch_vm::machine &m) {
+  constexpr std::size_t width = qch_vm::machine::display_width;
+
+  for (std::size_t y = 0; y < rows; y++) {
+    const std::size_t top = (2*y) * width;
+    const std::size_t bottom = (2*y + 1) * width;
+    for (std::size_t x = 0; x < cols; x++) {
+      cells[y*cols + x] = (m.gfx[top + x] ? 1 : 0) | (m.gfx[bottom + x] ? 2 : 0);
+    }
+  }
+
+  dirty = true;
+}
+
+void render::CursesRenderer::draw() {
+  if (!dirty) { return; }
+  dirty = false;
+
+  // only touch cells that changed, curses then emits the minimal update
+  bool changed = false;
+  for (std::size_t y = 0; y < rows; y++) {
+    for (std::size_t x = 0; x < cols; x++) {
+      const std::size_t i = y*cols + x;
+      if (cells[i] == drawn[i]) { continue; }
+
+      mvaddstr(y, x, glyphs[cells[i]]);
+      drawn[i] = cells[i];
+      changed = true;
+    }
+  }
+
+  if (changed) {
+    refresh();
+  }
+}
+
+void render::CursesRenderer::processInput(qch_vm::machine &m) {
+  const timing::seconds now = clock.get();
+
+  int ch;
+  while ((ch = getch()) != ERR) {
+    if (ch == key_escape) {
+      close = true;
+      continue;
+    }
+    auto hotkey = hotkey_map.find(ch);
+    if (hotkey != hotkey_map.end()) {
+      hotkey_expiry[hotkey->second] = now + key_hold;
+      continue;
+    }
+
+    auto it = key_map.find(ch);
+    if (it != key_map.end()) {
+      key_expiry[it->second] = now + key_hold;
+    }
+  }
+
+  for (std::size_t k = 0; k < key_expiry.size(); k++) {
+    m.keys[k] = key_expiry[k] > now;
+  }
+
+  uint32_t down = 0;
+  for (const auto &[hotkey, expiry] : hotkey_expiry) {
+    if (expiry > now) {
+      down |= to_underlying(hotkey);
+    }
+  }
+  setHotkeys(down);
+}
+
+bool render::CursesRenderer::shouldClose() const {
+  return close;
+}
@@ -0,0 +1,40 @@
+#ifndef __CURSES_RENDERER_HPP__
+#define __CURSES_RENDERER_HPP__
+#include <array>
+#include <cstdint>
+#include <map>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../util/timer.hpp"
+#include "renderer.hpp"
+
+namespace render {
+  // terminal backend, two vertically stacked pixels per character cell
+  class CursesRenderer : public Renderer {
+  public:
+    CursesRenderer();
+    ~CursesRenderer();
+
+    void upload(const qch_vm::machine &m) override;
+    void draw() override;
+    void processInput(qch_vm::machine &m) override;
+    bool shouldClose() const override;
+  private:
+    static constexpr std::size_t cols = qch_vm::machine::display_width;
+    static constexpr std::size_t rows = qch_vm::machine::display_height / 2;
+
+    // 2 bit cell state: bit 0 = top pixel, bit 1 = bottom pixel
+    std::array<uint8_t, cols*rows> cells{};
+    std::array<uint8_t, cols*rows> drawn{};
+    bool dirty = true;
+    bool close = false;
+
+    // terminals only report presses, so a key counts as held until this time
+    timing::Clock clock;
+    std::array<timing::seconds, 16> key_expiry{};
+    std::map<hotkey_t, timing::seconds> hotkey_expiry;
+  };
+}
+
+#endif // __CURSES_RENDERER_HPP__
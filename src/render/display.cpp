@@ -0,0 +1,44 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "display.hpp"
+
+// index 1 matches the original single plane colour
+const render::palette_t render::palette = {{
+  {  0,   0,   0, 255}, { 50, 150,  20, 255},
+  { 20,  60, 150, 255}, {200, 220,  80, 255},
+  {150,  40,  40, 255}, {220, 160,  40, 255},
+  {140,  60, 160, 255}, {230, 230, 230, 255},
+  { 60,  60,  60, 255}, {100, 200,  60, 255},
+  { 60, 110, 200, 255}, {230, 240, 140, 255},
+  {200,  80,  80, 255}, {240, 200,  90, 255},
+  {190, 110, 210, 255}, {255, 255, 255, 255}
+}};
+
+bool render::operator==(const display_mode &a, const display_mode &b) {
+  return a.width == b.width && a.height == b.height && a.planes == b.planes;
+}
+
+bool render::operator!=(const display_mode &a, const display_mode &b) {
+  return !(a == b);
+}
+
+render::display_mode render::current_display_mode(const qch_vm::machine &m) {
+  // qch_vm only implements the base 64x32 single plane display so far
+  return {m.display_width, m.display_height, 1};
+}
+
+void render::pack_planes(
+  const qch_vm::machine &m, const display_mode &mode,
+  std::vector<uint8_t> &out
+) {
+  const std::size_t size = mode.width * mode.height;
+  out.resize(size);
+
+  for (std::size_t i = 0; i < size; i++) {
+    out[i] = m.gfx[i] ? 1 : 0;
+  }
+}
@@ -0,0 +1,38 @@
+#ifndef __DISPLAY_HPP__
+#define __DISPLAY_HPP__
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+namespace render {
+  // resolution and number of bitplanes the machine is currently drawing with
+  // (64x32 chip-8, 128x64 schip hi-res, up to 4 xo-chip planes)
+  struct display_mode {
+    std::size_t width = 0;
+    std::size_t height = 0;
+    std::size_t planes = 0;
+  };
+
+  bool operator==(const display_mode &a, const display_mode &b);
+  bool operator!=(const display_mode &a, const display_mode &b);
+
+  static constexpr std::size_t max_planes = 4;
+
+  // rgba colour for every combination of lit planes
+  using palette_t = std::array<std::array<uint8_t, 4>, 1 << max_planes>;
+  extern const palette_t palette;
+
+  display_mode current_display_mode(const qch_vm::machine &m);
+
+  // packs every pixel into one byte, bit n set when plane n is lit
+  // `out` is resized to width*height of `mode`
+  void pack_planes(
+    const qch_vm::machine &m, const display_mode &mode,
+    std::vector<uint8_t> &out
+  );
+}
+
+#endif // __DISPLAY_HPP__
@@ -0,0 +1,190 @@
+#include <array>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <qxdg/qxdg.hpp>
+#include <qfio/qfio.hpp>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../gl/shader_program.hpp"
+#include "../gl/window.hpp"
+#include "../util/async_log.hpp"
+#include "../util/error.hpp"
+#include "../util/logged_io.hpp"
+#include "gl_common.hpp"
+#include "renderer.hpp"
+
+static constexpr int gl_major_version = 3;
+static constexpr int gl_minor_version = 3;
+
+static const std::map<int, uint8_t> key_map = {
+  {GLFW_KEY_X, 0x0},
+  {GLFW_KEY_1, 0x1},
+  {GLFW_KEY_2, 0x2},
+  {GLFW_KEY_3, 0x3},
+  {GLFW_KEY_Q, 0x4},
+  {GLFW_KEY_W, 0x5},
+  {GLFW_KEY_E, 0x6},
+  {GLFW_KEY_A, 0x7},
+  {GLFW_KEY_S, 0x8},
+  {GLFW_KEY_D, 0x9},
+  {GLFW_KEY_Z, 0xa},
+  {GLFW_KEY_C, 0xb},
+  {GLFW_KEY_4, 0xc},
+  {GLFW_KEY_R, 0xd},
+  {GLFW_KEY_F, 0xe},
+  {GLFW_KEY_V, 0xf}
+};
+
+static const std::map<int, render::hotkey_t> hotkey_map = {
+  {GLFW_KEY_F3, render::hotkey_t::hud},
+  {GLFW_KEY_F5, render::hotkey_t::save_state},
+  {GLFW_KEY_F6, render::hotkey_t::opcode_stats},
+  {GLFW_KEY_F9, render::hotkey_t::load_state},
+  {GLFW_KEY_BACKSPACE, render::hotkey_t::rewind},
+  {GLFW_KEY_PAGE_UP, render::hotkey_t::seek_back},
+  {GLFW_KEY_PAGE_DOWN, render::hotkey_t::seek_forward}
+};
+
+std::optional<error_code_t> render::open_window(
+  GLFWwindow *&window, logging::AsyncLog &log_stream
+) {
+  log_stream << "GLFW Version: " << glfwGetVersionString() << "\n";
+
+  // create opengl window and context
+  window = createWindow(
+    gl_major_version, gl_minor_version, true, window_width, window_height,
+    "qChip8"
+  );
+
+  if (window == nullptr) {
+    #ifdef DEBUG
+    log_stream << "failed to create window\n";
+    #endif
+
+    return error_code_t::window_failed;
+  }
+
+  glfwMakeContextCurrent(window);
+
+  // load opengl functions
+  if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+    #ifdef DEBUG
+    log_stream << "failed to initialise GLAD\n";
+    #endif
+
+    return error_code_t::glad_failed;
+  }
+
+  glViewport(0, 0, window_width, window_height);
+  glClearColor(0.1, 0.1, 0.2, 1.0);
+
+  log_stream << "OpenGL Version: " << glGetString(GL_VERSION) << "\n";
+
+  return {};
+}
+
+GLuint render::load_shader_program(
+  const xdg::base &base_dirs, const std::string &dir,
+  logging::AsyncLog &log_stream
+) {
+  auto v_shader_path = xdg::get_data_path(
+    base_dirs, "qchip", dir + "/vshader.glsl"
+    #ifdef DEBUG
+    , log_stream
+    #endif
+  );
+  auto f_shader_path = xdg::get_data_path(
+    base_dirs, "qchip", dir + "/fshader.glsl"
+    #ifdef DEBUG
+    , log_stream
+    #endif
+  );
+  if (!v_shader_path || !f_shader_path) {
+    log_stream << "could not find shaders in " << dir << "\n";
+    return 0;
+  }
+
+  auto v_shader_string = fio::read(*v_shader_path);
+  auto f_shader_string = fio::read(*f_shader_path);
+  if (!v_shader_string || !f_shader_string) {
+    log_stream << "could not read shaders in " << dir << "\n";
+    return 0;
+  }
+
+  GLuint v_shader = createShader(GL_VERTEX_SHADER, *v_shader_string);
+  GLuint f_shader = createShader(GL_FRAGMENT_SHADER, *f_shader_string);
+  #ifdef DEBUG
+  const auto v_compile_error = getCompileStatus(v_shader);
+  if (v_compile_error) {
+    log_stream << "vertex shader compilation failed\n";
+    log_stream << *v_compile_error << "\n";
+  }
+  const auto f_compile_error = getCompileStatus(f_shader);
+  if (f_compile_error) {
+    log_stream << "fragment shader compilation failed\n";
+    log_stream << *f_compile_error << "\n";
+  }
+  #endif
+
+  GLuint shader_program = createProgram(v_shader, f_shader, true);
+  #ifdef DEBUG
+  const auto link_error = getLinkStatus(shader_program);
+  if (link_error) {
+    log_stream << "shader program link failed\n";
+    log_stream << *link_error << "\n";
+  }
+  #endif
+
+  return shader_program;
+}
+
+void render::read_keypad(GLFWwindow *window, qch_vm::machine &m) {
+  if(glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+    glfwSetWindowShouldClose(window, true);
+  }
+
+  for (auto &[k, v] : key_map) {
+    int state = glfwGetKey(window, k);
+
+    if (state == GLFW_PRESS) {
+      m.keys[v] = true;
+    } else if (state == GLFW_RELEASE) {
+      m.keys[v] = false;
+    }
+  }
+}
+
+uint32_t render::read_hotkeys(GLFWwindow *window) {
+  uint32_t down = 0;
+  for (const auto &[k, hotkey] : hotkey_map) {
+    if (glfwGetKey(window, k) == GLFW_PRESS) {
+      down |= to_underlying(hotkey);
+    }
+  }
+
+  return down;
+}
+
+std::array<glm::mat4, 3> render::fullscreen_rect_matrices(
+  const int w, const int h
+) {
+  glm::mat4 projection = glm::ortho<double>(0, w, 0, h, 0.1, 100.0);
+
+  glm::mat4 view = glm::mat4(1.0);
+  view = glm::translate(view, glm::vec3(0.0, 0.0, -1.0));
+
+  glm::mat4 model = glm::mat4(1.0);
+  model = glm::scale(model, glm::vec3(w, h, 1));
+
+  return {projection, view, model};
+}
@@ -0,0 +1,46 @@
+#ifndef __GL_COMMON_HPP__
+#define __GL_COMMON_HPP__
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+
+#include <qxdg/qxdg.hpp>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../util/async_log.hpp"
+#include "../util/error.hpp"
+
+namespace render {
+  static constexpr int window_width = 640;
+  static constexpr int window_height = 480;
+
+  // creates the window, makes its context current and loads gl functions
+  std::optional<error_code_t> open_window(
+    GLFWwindow *&window, logging::AsyncLog &log_stream
+  );
+
+  // compiles and links `<dir>/vshader.glsl` and `<dir>/fshader.glsl`, 0 when
+  // they cannot be read
+  GLuint load_shader_program(
+    const xdg::base &base_dirs, const std::string &dir,
+    logging::AsyncLog &log_stream
+  );
+
+  // maps held keys into `m.keys`, escape requests the window to close
+  void read_keypad(GLFWwindow *window, qch_vm::machine &m);
+
+  // mask of the hotkeys currently held down
+  uint32_t read_hotkeys(GLFWwindow *window);
+
+  // projection, view and model matrices for a rect covering the window
+  std::array<glm::mat4, 3> fullscreen_rect_matrices(const int w, const int h);
+}
+
+#endif // __GL_COMMON_HPP__
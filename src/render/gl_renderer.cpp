@@ -0,0 +1,164 @@
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <qxdg/qxdg.hpp>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../gl/rect.hpp"
+#include "../gl/shader_program.hpp"
+#include "../gl/texture.hpp"
+#include "../util/async_log.hpp"
+#include "../util/error.hpp"
+#include "../util/timer.hpp"
+#include "display.hpp"
+#include "gl_common.hpp"
+#include "gl_renderer.hpp"
+#include "text.hpp"
+
+// window pixels per overlay pixel, and the overlay's distance from the corner
+static constexpr std::size_t overlay_scale = 2;
+static constexpr float overlay_margin = 8.0f;
+
+render::GLRenderer::~GLRenderer() {
+  if (overlay.id != 0) {
+    deleteTexture(overlay);
+  }
+  if (window != nullptr) {
+    glfwDestroyWindow(window);
+  }
+}
+
+std::optional<error_code_t> render::GLRenderer::init(
+  const xdg::base &base_dirs, logging::AsyncLog &log_stream
+) {
+  if (auto error = open_window(window, log_stream)) {
+    return error;
+  }
+
+  shader_program = load_shader_program(base_dirs, "shaders/tex", log_stream);
+
+  // palette indexed by the packed bitplanes of each pixel
+  std::array<GLfloat, palette.size() * 4> colours;
+  for (std::size_t i = 0; i < palette.size(); i++) {
+    for (std::size_t c = 0; c < 4; c++) {
+      colours[i*4 + c] = palette[i][c] / 255.0f;
+    }
+  }
+  glUseProgram(shader_program);
+  glUniform4fv(
+    glGetUniformLocation(shader_program, "palette"), palette.size(),
+    colours.data()
+  );
+
+  // create screen rect
+  rect = createRect();
+
+  auto [projection, view, model] = fullscreen_rect_matrices(
+    window_width, window_height
+  );
+
+  uniformMatrix4fv(shader_program, "projection", glm::value_ptr(projection));
+  uniformMatrix4fv(shader_program, "view", glm::value_ptr(view));
+  uniformMatrix4fv(shader_program, "model", glm::value_ptr(model));
+
+  return {};
+}
+
+void render::GLRenderer::upload(const qch_vm::machine &m) {
+  // only reallocate the texture when the resolution or plane count changes
+  const display_mode next = current_display_mode(m);
+  if (next != mode) {
+    if (texture.id != 0) {
+      deleteTexture(texture);
+    }
+    texture = create_index_texture(next.width, next.height);
+    mode = next;
+  }
+
+  pack_planes(m, mode, staging);
+
+  bindTexture(texture);
+  glTexSubImage2D(
+    GL_TEXTURE_2D, 0, 0, 0, mode.width, mode.height,
+    GL_RED_INTEGER, GL_UNSIGNED_BYTE, staging.data()
+  );
+  bindTexture({0});
+}
+
+void render::GLRenderer::draw() {
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  glUseProgram(shader_program);
+  bindTexture(texture);
+  drawRect(rect);
+
+  if (overlay_visible) {
+    glm::mat4 model = glm::translate(glm::mat4(1.0), glm::vec3(
+      overlay_margin,
+      window_height - overlay_margin - overlay_height * overlay_scale, 0.0
+    ));
+    model = glm::scale(model, glm::vec3(
+      overlay_width * overlay_scale, overlay_height * overlay_scale, 1
+    ));
+    uniformMatrix4fv(shader_program, "model", glm::value_ptr(model));
+    bindTexture(overlay);
+    drawRect(rect);
+
+    const glm::mat4 screen = fullscreen_rect_matrices(
+      window_width, window_height
+    )[2];
+    uniformMatrix4fv(shader_program, "model", glm::value_ptr(screen));
+  }
+
+  const timing::time_point start = timing::clock::now();
+  glfwSwapBuffers(window);
+  setPresentTime(timing::clock::now() - start);
+}
+
+void render::GLRenderer::processInput(qch_vm::machine &m) {
+  glfwPollEvents();
+  read_keypad(window, m);
+  setHotkeys(read_hotkeys(window));
+}
+
+bool render::GLRenderer::shouldClose() const {
+  return glfwWindowShouldClose(window);
+}
+
+void render::GLRenderer::setOverlay(const std::vector<std::string> &lines) {
+  overlay_visible = !lines.empty();
+  if (!overlay_visible) { return; }
+
+  // light text on dark grey, indices into the display palette
+  std::vector<uint8_t> pixels;
+  std::size_t w;
+  std::size_t h;
+  rasterize_text(lines, 15, 8, w, h, pixels);
+
+  if (w != overlay_width || h != overlay_height) {
+    if (overlay.id != 0) {
+      deleteTexture(overlay);
+    }
+    overlay = create_index_texture(w, h);
+    overlay_width = w;
+    overlay_height = h;
+  }
+
+  bindTexture(overlay);
+  glTexSubImage2D(
+    GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RED_INTEGER, GL_UNSIGNED_BYTE,
+    pixels.data()
+  );
+  bindTexture({0});
+}
@@ -0,0 +1,55 @@
+#ifndef __GL_RENDERER_HPP__
+#define __GL_RENDERER_HPP__
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include <qxdg/qxdg.hpp>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../gl/rect.hpp"
+#include "../gl/texture.hpp"
+#include "../util/async_log.hpp"
+#include "../util/error.hpp"
+#include "display.hpp"
+#include "renderer.hpp"
+
+namespace render {
+  // glfw window + opengl 3.3 texture/rect/shader path
+  class GLRenderer : public Renderer {
+  public:
+    ~GLRenderer();
+
+    std::optional<error_code_t> init(
+      const xdg::base &base_dirs, logging::AsyncLog &log_stream
+    );
+
+    void upload(const qch_vm::machine &m) override;
+    void draw() override;
+    void processInput(qch_vm::machine &m) override;
+    bool shouldClose() const override;
+    void setOverlay(const std::vector<std::string> &lines) override;
+  private:
+    GLFWwindow *window = nullptr;
+    GLuint shader_program = 0;
+    Texture texture;
+    Rect rect;
+
+    display_mode mode;
+    std::vector<uint8_t> staging;
+
+    // text overlay in the top left corner, drawn with the same shader
+    Texture overlay;
+    std::size_t overlay_width = 0;
+    std::size_t overlay_height = 0;
+    bool overlay_visible = false;
+  };
+}
+
+#endif // __GL_RENDERER_HPP__
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <vector>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <qxdg/qxdg.hpp>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../gl/rect.hpp"
+#include "../gl/shader_program.hpp"
+#include "../gl/texture.hpp"
+#include "../util/async_log.hpp"
+#include "../util/error.hpp"
+#include "gl_common.hpp"
+#include "gl_wall_renderer.hpp"
+
+render::GLWallRenderer::~GLWallRenderer() {
+  if (window != nullptr) {
+    glfwDestroyWindow(window);
+  }
+}
+
+std::optional<error_code_t> render::GLWallRenderer::init(
+  const xdg::base &base_dirs, logging::AsyncLog &log_stream,
+  const std::size_t instances
+) {
+  if (auto error = open_window(window, log_stream)) {
+    return error;
+  }
+
+  // every instance is one layer of the texture array
+  GLint max_layers = 0;
+  glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+  if (instances > static_cast<std::size_t>(max_layers)) {
+    log_stream << "at most " << max_layers << " instances are supported, "
+      << instances << " requested\n";
+    return error_code_t::invalid_args;
+  }
+
+  shader_program = load_shader_program(base_dirs, "shaders/wall", log_stream);
+
+  this->instances = instances;
+  staging.assign(instances * layer_size, 0);
+  dirty.assign(instances, true);
+
+  atlas = create_texture_array(
+    qch_vm::machine::display_width, qch_vm::machine::display_height, instances
+  );
+  rect = createRect();
+
+  // tiles keep the 2:1 display aspect, pick the column count that fits best
+  const double aspect = 0.5 * window_width / window_height;
+  const int cols = std::max(
+    1, static_cast<int>(std::ceil(std::sqrt(instances * aspect)))
+  );
+  const int rows = (instances + cols - 1) / cols;
+
+  auto [projection, view, model] = fullscreen_rect_matrices(
+    window_width, window_height
+  );
+
+  uniformMatrix4fv(shader_program, "projection", glm::value_ptr(projection));
+  uniformMatrix4fv(shader_program, "view", glm::value_ptr(view));
+  uniform2i(shader_program, "grid", cols, rows);
+
+  glUseProgram(shader_program);
+  glUniform2f(
+    glGetUniformLocation(shader_program, "tile_size"),
+    static_cast<float>(window_width) / cols,
+    static_cast<float>(window_height) / rows
+  );
+
+  return {};
+}
+
+void render::GLWallRenderer::upload(
+  const std::size_t index, const qch_vm::machine &m
+) {
+  std::copy(m.gfx.begin(), m.gfx.end(), staging.begin() + (index * layer_size));
+  dirty[index] = true;
+}
+
+void render::GLWallRenderer::draw() {
+  bindTextureArray(atlas);
+
+  // upload each run of consecutive dirty layers with one call
+  std::size_t i = 0;
+  while (i < instances) {
+    if (!dirty[i]) { i++; continue; }
+
+    std::size_t end = i;
+    while (end < instances && dirty[end]) {
+      dirty[end] = false;
+      end++;
+    }
+
+    glTexSubImage3D(
+      GL_TEXTURE_2D_ARRAY, 0, 0, 0, i,
+      qch_vm::machine::display_width, qch_vm::machine::display_height, end - i,
+      GL_RED, GL_UNSIGNED_BYTE, staging.data() + (i * layer_size)
+    );
+    i = end;
+  }
+
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  glUseProgram(shader_program);
+  drawRectInstanced(rect, instances);
+  glfwSwapBuffers(window);
+}
+
+void render::GLWallRenderer::processInput(
+  std::vector<qch_vm::machine> &machines
+) {
+  glfwPollEvents();
+  if (machines.empty()) { return; }
+
+  read_keypad(window, machines[0]);
+  for (std::size_t i = 1; i < machines.size(); i++) {
+    std::copy(
+      std::begin(machines[0].keys), std::end(machines[0].keys),
+      std::begin(machines[i].keys)
+    );
+  }
+}
+
+bool render::GLWallRenderer::shouldClose() const {
+  return glfwWindowShouldClose(window);
+}
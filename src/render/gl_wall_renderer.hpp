@@ -0,0 +1,55 @@
+#ifndef __GL_WALL_RENDERER_HPP__
+#define __GL_WALL_RENDERER_HPP__
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+#include <qxdg/qxdg.hpp>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../gl/rect.hpp"
+#include "../gl/texture.hpp"
+#include "../util/async_log.hpp"
+#include "../util/error.hpp"
+
+namespace render {
+  // draws many machines as a grid of tiles in one window
+  // every framebuffer is a layer of one texture array and all tiles are drawn
+  // with a single instanced draw call
+  class GLWallRenderer {
+  public:
+    ~GLWallRenderer();
+
+    std::optional<error_code_t> init(
+      const xdg::base &base_dirs, logging::AsyncLog &log_stream,
+      const std::size_t instances
+    );
+
+    // stages the framebuffer of instance `index`, uploaded on the next draw
+    void upload(const std::size_t index, const qch_vm::machine &m);
+    void draw();
+
+    // keypad state is shared by every instance
+    void processInput(std::vector<qch_vm::machine> &machines);
+    bool shouldClose() const;
+  private:
+    static constexpr std::size_t layer_size =
+      qch_vm::machine::display_width * qch_vm::machine::display_height;
+
+    GLFWwindow *window = nullptr;
+    GLuint shader_program = 0;
+    Texture atlas;
+    Rect rect;
+
+    std::size_t instances = 0;
+    std::vector<uint8_t> staging;
+    std::vector<bool> dirty;
+  };
+}
+
+#endif // __GL_WALL_RENDERER_HPP__
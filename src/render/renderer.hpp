@@ -0,0 +1,76 @@
+#ifndef __RENDERER_HPP__
+#define __RENDERER_HPP__
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../util/error.hpp"
+#include "../util/timer.hpp"
+
+namespace render {
+  enum class backend_t {
+    gl,
+    soft,
+    curses
+  };
+
+  // frontend commands bound to keys outside the keypad, used as a bit mask
+  enum class hotkey_t : uint32_t {
+    save_state = 1 << 0, // f5
+    load_state = 1 << 1, // f9
+    rewind = 1 << 2,     // backspace, held
+    seek_back = 1 << 3,  // page up, replays only
+    seek_forward = 1 << 4, // page down, replays only
+    opcode_stats = 1 << 5, // f6, OPCODE_STATS builds only
+    hud = 1 << 6          // f3, frame time overlay
+  };
+
+  class Renderer {
+  public:
+    virtual ~Renderer() = default;
+
+    // copy the machine's framebuffer into backend storage
+    virtual void upload(const qch_vm::machine &m) = 0;
+
+    // present the most recently uploaded frame
+    virtual void draw() = 0;
+
+    // poll host input and update `m.keys`
+    virtual void processInput(qch_vm::machine &m) = 0;
+
+    virtual bool shouldClose() const = 0;
+
+    // text drawn over the frame until replaced, nothing when empty; only
+    // backends with a window show it
+    virtual void setOverlay(const std::vector<std::string> &) {}
+
+    // time the last draw spent presenting, e.g. blocked in a buffer swap
+    timing::seconds presentTime() const { return present_time; }
+
+    // hotkeys that went down since the last call
+    uint32_t takeHotkeys() {
+      const uint32_t mask = pressed;
+      pressed = 0;
+      return mask;
+    }
+
+    // hotkeys held down as of the last processInput
+    uint32_t heldHotkeys() const { return held; }
+  protected:
+    // backends report which hotkeys are down on every processInput
+    void setHotkeys(const uint32_t down) {
+      pressed |= down & ~held;
+      held = down;
+    }
+
+    void setPresentTime(const timing::seconds t) { present_time = t; }
+  private:
+    uint32_t pressed = 0;
+    uint32_t held = 0;
+    timing::seconds present_time{0.0};
+  };
+}
+
+#endif // __RENDERER_HPP__
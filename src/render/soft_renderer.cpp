@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "../util/image.hpp"
+#include "display.hpp"
+#include "soft_renderer.hpp"
+
+render::SoftRenderer::SoftRenderer(
+  const std::size_t scale, const std::optional<std::string> &frame_dir,
+  const frame_format_t frame_format
+) : scale(scale == 0 ? 1 : scale),
+    frame_dir(frame_dir), frame_format(frame_format) {}
+
+void render::SoftRenderer::upload(const qch_vm::machine &m) {
+  const display_mode next = current_display_mode(m);
+  if (next != mode) {
+    mode = next;
+    w = mode.width * scale;
+    h = mode.height * scale;
+    rgba.assign(w * h * 4, 0);
+  }
+
+  pack_planes(m, mode, planes);
+
+  for (std::size_t y = 0; y < mode.height; y++) {
+    uint8_t *dst = rgba.data() + (y * scale * w * 4);
+
+    // expand one source row, then duplicate it for the remaining scanlines
+    for (std::size_t x = 0; x < mode.width; x++) {
+      const auto &c = palette[planes[y*mode.width + x] & 0xf];
+      for (std::size_t s = 0; s < scale; s++) {
+        uint8_t *p = dst + ((x*scale + s) * 4);
+        p[0] = c[0]; p[1] = c[1]; p[2] = c[2]; p[3] = c[3];
+      }
+    }
+    for (std::size_t s = 1; s < scale; s++) {
+      std::copy(dst, dst + (w * 4), dst + (s * w * 4));
+    }
+  }
+
+  dirty = true;
+}
+
+void render::SoftRenderer::draw() {
+  if (!dirty || !frame_dir) { return; }
+  dirty = false;
+
+  const char *ext = (frame_format == frame_format_t::png) ? "png" : "ppm";
+  char name[32];
+  std::snprintf(name, sizeof(name), "/frame_%06zu.%s", frame_count++, ext);
+  const std::string path = *frame_dir + name;
+
+  if (frame_format == frame_format_t::png) {
+    image::write_png(path, w, h, rgba.data());
+  } else {
+    image::write_ppm(path, w, h, rgba.data());
+  }
+}
+
+void render::SoftRenderer::processInput(qch_vm::machine &) {}
+
+bool render::SoftRenderer::shouldClose() const {
+  return false;
+}
+
+std::size_t render::SoftRenderer::width() const {
+  return w;
+}
+
+std::size_t render::SoftRenderer::height() const {
+  return h;
+}
+
+const std::vector<uint8_t> &render::SoftRenderer::pixels() const {
+  return rgba;
+}
@@ -0,0 +1,52 @@
+#ifndef __SOFT_RENDERER_HPP__
+#define __SOFT_RENDERER_HPP__
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <qch_vm/qch_vm.hpp>
+
+#include "display.hpp"
+#include "renderer.hpp"
+
+namespace render {
+  enum class frame_format_t {
+    ppm,
+    png
+  };
+
+  // pure cpu backend, scales `m.gfx` into an in-memory rgba buffer
+  class SoftRenderer : public Renderer {
+  public:
+    SoftRenderer(
+      const std::size_t scale,
+      const std::optional<std::string> &frame_dir={},
+      const frame_format_t frame_format=frame_format_t::ppm
+    );
+
+    void upload(const qch_vm::machine &m) override;
+    void draw() override;
+    void processInput(qch_vm::machine &m) override;
+    bool shouldClose() const override;
+
+    std::size_t width() const;
+    std::size_t height() const;
+    const std::vector<uint8_t> &pixels() const;
+  private:
+    std::size_t scale;
+    display_mode mode;
+    std::size_t w = 0;
+    std::size_t h = 0;
+    std::vector<uint8_t> planes;
+    std::vector<uint8_t> rgba;
+
+    std::optional<std::string> frame_dir;
+    frame_format_t frame_format;
+    std::size_t frame_count = 0;
+    bool dirty = false;
+  };
+}
+
+#endif // __SOFT_RENDERER_HPP__
@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "text.hpp"
+
+// rows top to bottom, bit 2 is the leftmost column
+static const std::map<char, std::array<uint8_t, render::glyph_height>> font = {
+  {'0', {7, 5, 5, 5, 7}}, {'1', {2, 6, 2, 2, 7}}, {'2', {7, 1, 7, 4, 7}},
+  {'3', {7, 1, 7, 1, 7}}, {'4', {5, 5, 7, 1, 1}}, {'5', {7, 4, 7, 1, 7}},
+  {'6', {7, 4, 7, 5, 7}}, {'7', {7, 1, 1, 2, 2}}, {'8', {7, 5, 7, 5, 7}},
+  {'9', {7, 5, 7, 1, 7}},
+  {'a', {2, 5, 7, 5, 5}}, {'b', {6, 5, 6, 5, 6}}, {'c', {3, 4, 4, 4, 3}},
+  {'d', {6, 5, 5, 5, 6}}, {'e', {7, 4, 6, 4, 7}}, {'f', {7, 4, 6, 4, 4}},
+  {'g', {3, 4, 5, 5, 3}}, {'h', {5, 5, 7, 5, 5}}, {'i', {7, 2, 2, 2, 7}},
+  {'j', {1, 1, 1, 5, 2}}, {'k', {5, 5, 6, 5, 5}}, {'l', {4, 4, 4, 4, 7}},
+  {'m', {5, 7, 7, 5, 5}}, {'n', {6, 5, 5, 5, 5}}, {'o', {2, 5, 5, 5, 2}},
+  {'p', {6, 5, 6, 4, 4}}, {'q', {2, 5, 5, 6, 3}}, {'r', {6, 5, 6, 5, 5}},
+  {'s', {3, 4, 2, 1, 6}}, {'t', {7, 2, 2, 2, 2}}, {'u', {5, 5, 5, 5, 7}},
+  {'v', {5, 5, 5, 5, 2}}, {'w', {5, 5, 7, 7, 5}}, {'x', {5, 5, 2, 5, 5}},
+  {'y', {5, 5, 2, 2, 2}}, {'z', {7, 1, 2, 4, 7}},
+  {'.', {0, 0, 0, 0, 2}}, {'%', {5, 1, 2, 4, 5}}, {'-', {0, 0, 7, 0, 0}},
+  {':', {0, 2, 0, 2, 0}}, {'/', {1, 1, 2, 4, 4}}
+};
+
+void render::rasterize_text(
+  const std::vector<std::string> &lines, const uint8_t fg, const uint8_t bg,
+  std::size_t &width, std::size_t &height, std::vector<uint8_t> &out
+) {
+  std::size_t columns = 0;
+  for (const std::string &line : lines) {
+    columns = std::max(columns, line.size());
+  }
+
+  width = columns * (glyph_width + 1) + 1;
+  height = lines.size() * (glyph_height + 1) + 1;
+  out.assign(width * height, bg);
+
+  for (std::size_t l = 0; l < lines.size(); l++) {
+    for (std::size_t c = 0; c < lines[l].size(); c++) {
+      const auto glyph = font.find(static_cast<char>(
+        std::tolower(static_cast<unsigned char>(lines[l][c]))
+      ));
+      if (glyph == font.end()) { continue; }
+
+      const std::size_t x0 = 1 + c * (glyph_width + 1);
+      const std::size_t y0 = 1 + l * (glyph_height + 1);
+      for (std::size_t y = 0; y < glyph_height; y++) {
+        for (std::size_t x = 0; x < glyph_width; x++) {
+          if (glyph->second[y] & (4 >> x)) {
+            out[(y0 + y) * width + x0 + x] = fg;
+          }
+        }
+      }
+    }
+  }
+}
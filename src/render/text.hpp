@@ -0,0 +1,23 @@
+#ifndef __TEXT_HPP__
+#define __TEXT_HPP__
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace render {
+  // 3x5 pixel glyphs for digits, lower case letters and a few symbols,
+  // anything else is drawn as a space
+  static constexpr std::size_t glyph_width = 3;
+  static constexpr std::size_t glyph_height = 5;
+
+  // rasterizes `lines` as palette indices `fg` on `bg`, top row first, with
+  // a one pixel gap between glyphs and lines and around the text
+  // `out` is resized to width*height
+  void rasterize_text(
+    const std::vector<std::string> &lines, const uint8_t fg, const uint8_t bg,
+    std::size_t &width, std::size_t &height, std::vector<uint8_t> &out
+  );
+}
+
+#endif // __TEXT_HPP__
@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <qfio/qfio.hpp>
+
+#include "async_log.hpp"
+
+// how often the writer looks for new records
+static constexpr std::chrono::milliseconds writer_interval(10);
+
+// the line a thread is building, between newlines
+struct pending_line {
+  const logging::AsyncLog *owner = nullptr;
+  std::string text;
+};
+static thread_local pending_line pending;
+
+static std::size_t ring_size(const std::size_t slot_count) {
+  std::size_t size = 1;
+  while (size < slot_count) {
+    size <<= 1;
+  }
+  return size;
+}
+
+logging::AsyncLog::AsyncLog(
+  const std::string &path, const std::size_t slot_count
+) : slots(std::make_unique<slot[]>(ring_size(slot_count))),
+    mask(ring_size(slot_count) - 1)
+{
+  // a slot is free for the producer claiming position n when its sequence
+  // is n, and holds a record for the writer when it is n + 1
+  for (std::size_t n = 0; n <= mask; n++) {
+    this->slots[n].sequence.store(n, std::memory_order_relaxed);
+  }
+
+  writer = std::thread([this, path]{ run(path); });
+}
+
+logging::AsyncLog::~AsyncLog() {
+  if (pending.owner == this && !pending.text.empty()) {
+    push(pending.text);
+    pending.text.clear();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(stop_mutex);
+    stopping = true;
+  }
+  stop_cv.notify_one();
+  writer.join();
+}
+
+uint64_t logging::AsyncLog::dropped() const {
+  return lost.load(std::memory_order_relaxed);
+}
+
+void logging::AsyncLog::append(std::string_view text) {
+  if (pending.owner != this) {
+    pending.owner = this;
+    pending.text.clear();
+  }
+  pending.text.append(text);
+
+  const std::size_t end = pending.text.rfind('\n');
+  if (end == std::string::npos) {
+    return;
+  }
+
+  push(std::string_view(pending.text).substr(0, end + 1));
+  pending.text.erase(0, end + 1);
+}
+
+bool logging::AsyncLog::push(std::string_view text) {
+  // records longer than the whole ring are cut short
+  const std::size_t capacity = mask + 1;
+  const std::size_t count = std::min(
+    (text.size() + slot_bytes - 1) / slot_bytes, capacity
+  );
+  text = text.substr(0, count * slot_bytes);
+
+  uint64_t pos = enqueue_pos.load(std::memory_order_relaxed);
+  for (;;) {
+    bool free = true;
+    for (std::size_t n = 0; n < count && free; n++) {
+      free = slots[(pos + n) & mask].sequence.load(std::memory_order_acquire)
+        == pos + n;
+    }
+
+    if (free) {
+      if (enqueue_pos.compare_exchange_weak(
+        pos, pos + count, std::memory_order_relaxed
+      )) {
+        break;
+      }
+      continue;
+    }
+
+    // full unless another producer moved the position meanwhile
+    const uint64_t now = enqueue_pos.load(std::memory_order_relaxed);
+    if (now == pos) {
+      lost.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    pos = now;
+  }
+
+  for (std::size_t n = 0; n < count; n++) {
+    slot &s = slots[(pos + n) & mask];
+    const std::string_view part = text.substr(n * slot_bytes, slot_bytes);
+    s.size = static_cast<uint8_t>(part.size());
+    std::copy(part.begin(), part.end(), s.text);
+    s.sequence.store(pos + n + 1, std::memory_order_release);
+  }
+
+  return true;
+}
+
+void logging::AsyncLog::drain(std::string &out) {
+  const std::size_t capacity = mask + 1;
+
+  for (;;) {
+    slot &s = slots[dequeue_pos & mask];
+    if (s.sequence.load(std::memory_order_acquire) != dequeue_pos + 1) {
+      return;
+    }
+
+    out.append(s.text, s.size);
+    s.sequence.store(dequeue_pos + capacity, std::memory_order_release);
+    dequeue_pos++;
+  }
+}
+
+void logging::AsyncLog::run(const std::string &path) {
+  fio::log_stream_f sink(path);
+  std::string batch;
+  uint64_t reported = 0;
+
+  bool stop = false;
+  while (!stop) {
+    {
+      std::unique_lock<std::mutex> lock(stop_mutex);
+      stop = stop_cv.wait_for(lock, writer_interval, [this]{ return stopping; });
+    }
+
+    batch.clear();
+    drain(batch);
+
+    const uint64_t lost_now = dropped();
+    if (lost_now != reported) {
+      batch += "[w] " + std::to_string(lost_now - reported)
+        + " log records dropped\n";
+      reported = lost_now;
+    }
+
+    if (!batch.empty()) {
+      sink << batch;
+    }
+  }
+}
@@ -0,0 +1,88 @@
+#ifndef __ASYNC_LOG_HPP__
+#define __ASYNC_LOG_HPP__
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+namespace logging {
+  // log file written by a background thread
+  //
+  // every thread builds its lines separately; a finished line is copied
+  // into a bounded ring of fixed size slots as one record, claimed with a
+  // compare and swap, so logging never takes a lock or waits for the disk.
+  // When the writer falls behind and the ring is full, records are dropped
+  // and counted instead. One instance per process.
+  class AsyncLog {
+  public:
+    static constexpr std::size_t slot_bytes = 119; // 128 byte slots
+
+    // memory use is fixed at `slot_count` * 128 bytes, rounded up to a power of two
+    AsyncLog(const std::string &path, const std::size_t slot_count=1024);
+
+    // writes what is queued, including the calling thread's unfinished line
+    ~AsyncLog();
+
+    AsyncLog(const AsyncLog &) = delete;
+    AsyncLog &operator=(const AsyncLog &) = delete;
+
+    template <typename T>
+    AsyncLog &operator<<(const T &value) {
+      if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+        append(value);
+      } else if constexpr (std::is_same_v<T, char>) {
+        append(std::string_view(&value, 1));
+      } else if constexpr (
+        std::is_integral_v<T> && !std::is_same_v<T, bool>
+      ) {
+        char digits[24];
+        const auto end = std::to_chars(digits, digits + sizeof(digits), value);
+        append(std::string_view(digits, end.ptr - digits));
+      } else {
+        std::ostringstream os;
+        os << value;
+        append(os.str());
+      }
+      return *this;
+    }
+
+    // records lost because the ring was full
+    uint64_t dropped() const;
+  private:
+    struct slot {
+      std::atomic<uint64_t> sequence;
+      uint8_t size;
+      char text[slot_bytes];
+    };
+
+    // adds to this thread's line, queueing it once it ends with a newline
+    void append(std::string_view text);
+
+    // claims consecutive slots for one record, false when it was dropped
+    bool push(std::string_view text);
+
+    void run(const std::string &path);
+    void drain(std::string &out);
+
+    std::unique_ptr<slot[]> slots;
+    std::size_t mask;
+    alignas(64) std::atomic<uint64_t> enqueue_pos{0};
+    alignas(64) std::atomic<uint64_t> lost{0};
+    uint64_t dequeue_pos = 0; // writer thread only
+
+    std::mutex stop_mutex;
+    std::condition_variable stop_cv;
+    bool stopping = false;
+    std::thread writer;
+  };
+}
+
+#endif // __ASYNC_LOG_HPP__
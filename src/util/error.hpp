@@ -9,8 +9,14 @@ constexpr auto to_underlying(E e) noexcept {
 enum class error_code_t {
   not_enough_args = 1,
   too_many_args = 2,
+  invalid_args = 3,
   window_failed = 16,
   glad_failed = 17,
+  verify_failed = 32,
+  bench_regressed = 33,
+  fuzz_hang = 34,
+  batch_mismatch = 35,
+  replay_mismatch = 36,
 
 };
 
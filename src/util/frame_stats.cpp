@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "frame_stats.hpp"
+#include "timer.hpp"
+
+static const char *phase_names[timing::phase_count] = {
+  "input", "emu", "output", "draw", "swap"
+};
+
+timing::FrameStats::FrameStats(const std::size_t window)
+  : window(std::max<std::size_t>(window, 1)),
+    totals(this->window), emulated(this->window)
+{
+  for (auto &p : phases) {
+    p.resize(this->window);
+  }
+}
+
+void timing::FrameStats::add(const phase_t phase, const seconds t) {
+  current[static_cast<std::size_t>(phase)] += t.count() * 1000.0;
+}
+
+void timing::FrameStats::endFrame(
+  const seconds total, const seconds emulated_time
+) {
+  for (std::size_t p = 0; p < phase_count; p++) {
+    phases[p][next] = current[p];
+    current[p] = 0.0;
+  }
+  totals[next] = total.count() * 1000.0;
+  emulated[next] = emulated_time.count() * 1000.0;
+
+  next = (next + 1) % window;
+  count = std::min(count + 1, window);
+}
+
+std::size_t timing::FrameStats::frames() const {
+  return count;
+}
+
+double timing::FrameStats::quantile(
+  const std::vector<double> &values, const double q
+) const {
+  if (count == 0) {
+    return 0.0;
+  }
+
+  // only the first `count` slots hold samples until the window fills
+  std::vector<double> sorted(values.begin(), values.begin() + count);
+  const std::size_t k = std::min(
+    static_cast<std::size_t>(q * (count - 1) + 0.5), count - 1
+  );
+  std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+  return sorted[k];
+}
+
+double timing::FrameStats::percentile(const phase_t phase, const double q) const {
+  return quantile(phases[static_cast<std::size_t>(phase)], q);
+}
+
+double timing::FrameStats::framePercentile(const double q) const {
+  return quantile(totals, q);
+}
+
+double timing::FrameStats::speed() const {
+  double wall = 0.0;
+  double machine = 0.0;
+  for (std::size_t i = 0; i < count; i++) {
+    wall += totals[i];
+    machine += emulated[i];
+  }
+  return wall > 0.0 ? 100.0 * machine / wall : 0.0;
+}
+
+std::vector<std::string> timing::FrameStats::summary() const {
+  std::vector<std::string> lines;
+  char line[64];
+
+  lines.push_back("ms       p50    p95    p99");
+  for (std::size_t p = 0; p < phase_count; p++) {
+    const phase_t phase = static_cast<phase_t>(p);
+    std::snprintf(
+      line, sizeof(line), "%-6s %6.2f %6.2f %6.2f", phase_names[p],
+      percentile(phase, 0.5), percentile(phase, 0.95), percentile(phase, 0.99)
+    );
+    lines.push_back(line);
+  }
+  std::snprintf(
+    line, sizeof(line), "%-6s %6.2f %6.2f %6.2f", "frame",
+    framePercentile(0.5), framePercentile(0.95), framePercentile(0.99)
+  );
+  lines.push_back(line);
+
+  std::snprintf(line, sizeof(line), "speed  %5.1f%%", speed());
+  lines.push_back(line);
+
+  return lines;
+}
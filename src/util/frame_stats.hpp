@@ -0,0 +1,58 @@
+#ifndef __FRAME_STATS_HPP__
+#define __FRAME_STATS_HPP__
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "timer.hpp"
+
+namespace timing {
+  // parts of one main loop iteration
+  enum class phase_t : std::size_t {
+    input,   // host input, control clients, hotkeys
+    emulate, // cycle slots, rewind and run-ahead
+    output,  // texture uploads, capture and shared memory
+    draw,    // rendering commands
+    swap     // buffer swap, usually waiting for vsync
+  };
+  static constexpr std::size_t phase_count = 5;
+
+  // phase durations of the last `window` iterations
+  class FrameStats {
+  public:
+    FrameStats(const std::size_t window=300);
+
+    // adds to the phase of the iteration in progress
+    void add(const phase_t phase, const seconds t);
+
+    // closes the iteration, which took `total` on the wall clock and
+    // emulated `emulated` of machine time
+    void endFrame(const seconds total, const seconds emulated);
+
+    std::size_t frames() const;
+
+    // milliseconds at quantile `q` (0 to 1) of a phase or of whole iterations
+    double percentile(const phase_t phase, const double q) const;
+    double framePercentile(const double q) const;
+
+    // emulated time as a percentage of wall clock time over the window
+    double speed() const;
+
+    // p50/p95/p99 table of every phase, then the speed
+    std::vector<std::string> summary() const;
+  private:
+    double quantile(const std::vector<double> &values, const double q) const;
+
+    std::size_t window;
+    std::size_t next = 0;
+    std::size_t count = 0;
+
+    std::array<std::vector<double>, phase_count> phases; // ms per iteration
+    std::vector<double> totals; // ms
+    std::vector<double> emulated; // ms
+    std::array<double, phase_count> current{};
+  };
+}
+
+#endif // __FRAME_STATS_HPP__
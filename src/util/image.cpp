@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "image.hpp"
+
+static uint32_t crc32(const uint8_t *data, const std::size_t size, uint32_t c);
+static uint32_t adler32(const uint8_t *data, const std::size_t size);
+static void put_u32_be(std::vector<uint8_t> &out, const uint32_t v);
+static void write_chunk(
+  std::ofstream &ofs, const char *type, const std::vector<uint8_t> &data
+);
+
+bool image::write_ppm(
+  const std::string &path, const std::size_t width, const std::size_t height,
+  const uint8_t *rgba
+) {
+  std::ofstream ofs(path, std::ios::binary);
+  if (!ofs) { return false; }
+
+  ofs << "P6\n" << width << " " << height << "\n255\n";
+
+  std::vector<uint8_t> row(width * 3);
+  for (std::size_t y = 0; y < height; y++) {
+    const uint8_t *src = rgba + (y * width * 4);
+    for (std::size_t x = 0; x < width; x++) {
+      row[x*3 + 0] = src[x*4 + 0];
+      row[x*3 + 1] = src[x*4 + 1];
+      row[x*3 + 2] = src[x*4 + 2];
+    }
+    ofs.write(reinterpret_cast<const char *>(row.data()), row.size());
+  }
+
+  return static_cast<bool>(ofs);
+}
+
+bool image::write_png(
+  const std::string &path, const std::size_t width, const std::size_t height,
+  const uint8_t *rgba
+) {
+  std::ofstream ofs(path, std::ios::binary);
+  if (!ofs) { return false; }
+
+  static constexpr uint8_t signature[8] = {
+    0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'
+  };
+  ofs.write(reinterpret_cast<const char *>(signature), sizeof(signature));
+
+  std::vector<uint8_t> ihdr;
+  put_u32_be(ihdr, width);
+  put_u32_be(ihdr, height);
+  ihdr.push_back(8); // bit depth
+  ihdr.push_back(6); // colour type: rgba
+  ihdr.push_back(0); // compression
+  ihdr.push_back(0); // filter
+  ihdr.push_back(0); // interlace
+  write_chunk(ofs, "IHDR", ihdr);
+
+  // raw scanlines, each prefixed with filter type 0
+  const std::size_t stride = width * 4;
+  std::vector<uint8_t> raw;
+  raw.reserve((stride + 1) * height);
+  for (std::size_t y = 0; y < height; y++) {
+    raw.push_back(0);
+    raw.insert(raw.end(), rgba + (y * stride), rgba + ((y + 1) * stride));
+  }
+
+  // zlib stream made of stored deflate blocks
+  static constexpr std::size_t max_block = 0xffff;
+  std::vector<uint8_t> idat = {0x78, 0x01};
+  std::size_t offset = 0;
+  do {
+    const std::size_t len = std::min(max_block, raw.size() - offset);
+    const bool final = (offset + len) == raw.size();
+    idat.push_back(final ? 1 : 0);
+    idat.push_back(len & 0xff);
+    idat.push_back((len >> 8) & 0xff);
+    idat.push_back(~len & 0xff);
+    idat.push_back((~len >> 8) & 0xff);
+    idat.insert(idat.end(), raw.begin() + offset, raw.begin() + offset + len);
+    offset += len;
+  } while (offset < raw.size());
+  put_u32_be(idat, adler32(raw.data(), raw.size()));
+  write_chunk(ofs, "IDAT", idat);
+
+  write_chunk(ofs, "IEND", {});
+
+  return static_cast<bool>(ofs);
+}
+
+bool image::write_pbm(const std::string &path, const bitmap &b) {
+  std::ofstream ofs(path, std::ios::binary);
+  if (!ofs) { return false; }
+
+  ofs << "P4\n" << b.width << " " << b.height << "\n";
+
+  const std::size_t row_bytes = (b.width + 7) / 8;
+  std::vector<uint8_t> row(row_bytes);
+  for (std::size_t y = 0; y < b.height; y++) {
+    std::fill(row.begin(), row.end(), 0);
+    for (std::size_t x = 0; x < b.width; x++) {
+      if (b.pixels[y*b.width + x]) {
+        row[x / 8] |= 0x80 >> (x % 8);
+      }
+    }
+    ofs.write(reinterpret_cast<const char *>(row.data()), row.size());
+  }
+
+  return static_cast<bool>(ofs);
+}
+
+std::optional<image::bitmap> image::read_pbm(const std::string &path) {
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs) { return {}; }
+
+  std::string magic;
+  bitmap b;
+  ifs >> magic >> b.width >> b.height;
+  ifs.get(); // single whitespace before the raster
+  if (!ifs || magic != "P4") { return {}; }
+
+  const std::size_t row_bytes = (b.width + 7) / 8;
+  std::vector<uint8_t> row(row_bytes);
+  b.pixels.resize(b.width * b.height);
+  for (std::size_t y = 0; y < b.height; y++) {
+    ifs.read(reinterpret_cast<char *>(row.data()), row.size());
+    for (std::size_t x = 0; x < b.width; x++) {
+      b.pixels[y*b.width + x] = (row[x / 8] >> (7 - (x % 8))) & 1;
+    }
+  }
+
+  if (!ifs) { return {}; }
+  return b;
+}
+
+static uint32_t crc32(const uint8_t *data, const std::size_t size, uint32_t c) {
+  static const std::array<uint32_t, 256> table = [](){
+    std::array<uint32_t, 256> t{};
+    for (uint32_t n = 0; n < 256; n++) {
+      uint32_t v = n;
+      for (int k = 0; k < 8; k++) {
+        v = (v & 1) ? (0xedb88320 ^ (v >> 1)) : (v >> 1);
+      }
+      t[n] = v;
+    }
+    return t;
+  }();
+
+  c = ~c;
+  for (std::size_t i = 0; i < size; i++) {
+    c = table[(c ^ data[i]) & 0xff] ^ (c >> 8);
+  }
+
+  return ~c;
+}
+
+static uint32_t adler32(const uint8_t *data, const std::size_t size) {
+  uint32_t a = 1;
+  uint32_t b = 0;
+  for (std::size_t i = 0; i < size; i++) {
+    a = (a + data[i]) % 65521;
+    b = (b + a) % 65521;
+  }
+
+  return (b << 16) | a;
+}
+
+static void put_u32_be(std::vector<uint8_t> &out, const uint32_t v) {
+  out.push_back((v >> 24) & 0xff);
+  out.push_back((v >> 16) & 0xff);
+  out.push_back((v >> 8) & 0xff);
+  out.push_back(v & 0xff);
+}
+
+static void write_chunk(
+  std::ofstream &ofs, const char *type, const std::vector<uint8_t> &data
+) {
+  std::vector<uint8_t> header;
+  put_u32_be(header, data.size());
+  header.insert(header.end(), type, type + 4);
+
+  uint32_t crc = crc32(header.data() + 4, 4, 0);
+  crc = crc32(data.data(), data.size(), crc);
+
+  std::vector<uint8_t> footer;
+  put_u32_be(footer, crc);
+
+  ofs.write(reinterpret_cast<const char *>(header.data()), header.size());
+  ofs.write(reinterpret_cast<const char *>(data.data()), data.size());
+  ofs.write(reinterpret_cast<const char *>(footer.data()), footer.size());
+}
@@ -0,0 +1,34 @@
+#ifndef __IMAGE_HPP__
+#define __IMAGE_HPP__
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace image {
+  // `rgba` is tightly packed, 4 bytes per pixel, top row first
+  bool write_ppm(
+    const std::string &path, const std::size_t width, const std::size_t height,
+    const uint8_t *rgba
+  );
+
+  // png is written with uncompressed (stored) deflate blocks, so no zlib
+  bool write_png(
+    const std::string &path, const std::size_t width, const std::size_t height,
+    const uint8_t *rgba
+  );
+
+  // 1 bit image, one byte per pixel in memory (non-zero = set)
+  struct bitmap {
+    std::size_t width = 0;
+    std::size_t height = 0;
+    std::vector<uint8_t> pixels;
+  };
+
+  // binary pbm (P4)
+  bool write_pbm(const std::string &path, const bitmap &b);
+  std::optional<bitmap> read_pbm(const std::string &path);
+}
+
+#endif // __IMAGE_HPP__
@@ -0,0 +1,37 @@
+#include <optional>
+#include <string>
+
+#include <qxdg/qxdg.hpp>
+#include <qfio/qfio.hpp>
+
+#include "async_log.hpp"
+#include "logged_io.hpp"
+
+#ifdef DEBUG
+std::optional<xdg::path_t> xdg::get_data_path(
+  const xdg::base &b, const std::string &n, const std::string &p,
+  logging::AsyncLog &log_stream, const bool create
+) {
+  log_stream << "Fetching path: " << p << "\n";
+  auto path = xdg::get_data_path(b, n, p);
+  if (!path) {
+    log_stream << "[w] `" << p << "` not found...\n";
+  } else {
+    log_stream << "--> " << *path << "\n";
+  }
+
+  return path;
+}
+
+std::optional<xdg::path_t> fio::read(
+  const xdg::path_t &path, logging::AsyncLog &log_stream
+) {
+  log_stream << "Loading file: " << path << "\n";
+  auto data = fio::read(path);
+  if (!data) {
+    log_stream << "[w] Could not read file...\n";
+  }
+
+  return data;
+}
+#endif
@@ -0,0 +1,25 @@
+#ifndef __LOGGED_IO_HPP__
+#define __LOGGED_IO_HPP__
+#include <optional>
+#include <string>
+
+#include <qxdg/qxdg.hpp>
+#include <qfio/qfio.hpp>
+
+#include "async_log.hpp"
+
+#ifdef DEBUG
+namespace xdg {
+  std::optional<xdg::path_t> get_data_path(
+    const xdg::base &b, const std::string &n, const std::string &p,
+    logging::AsyncLog &log_stream, const bool create=false
+  );
+}
+namespace fio {
+  std::optional<xdg::path_t> read(
+    const xdg::path_t &path, logging::AsyncLog &log_stream
+  );
+}
+#endif
+
+#endif // __LOGGED_IO_HPP__
@@ -0,0 +1,45 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "manifest.hpp"
+
+std::vector<manifest::line> manifest::parse(const std::string &text) {
+  std::vector<line> lines;
+
+  std::istringstream iss(text);
+  std::string l;
+  while (std::getline(iss, l)) {
+    line parsed;
+    parsed.text = l;
+
+    std::istringstream fields(l.substr(0, l.find('#')));
+    std::string field;
+    while (fields >> field) {
+      parsed.fields.push_back(field);
+    }
+
+    lines.push_back(parsed);
+  }
+
+  return lines;
+}
+
+std::string manifest::join(const std::vector<std::string> &fields) {
+  std::string out;
+  for (const auto &f : fields) {
+    if (!out.empty()) { out += " "; }
+    out += f;
+  }
+
+  return out;
+}
+
+std::string manifest::to_string(const std::vector<line> &lines) {
+  std::string out;
+  for (const auto &l : lines) {
+    out += l.text + "\n";
+  }
+
+  return out;
+}
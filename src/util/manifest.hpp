@@ -0,0 +1,21 @@
+#ifndef __MANIFEST_HPP__
+#define __MANIFEST_HPP__
+#include <string>
+#include <vector>
+
+// whitespace separated text tables, `#` starts a comment
+namespace manifest {
+  struct line {
+    std::string text;
+    std::vector<std::string> fields; // empty for blank and comment lines
+  };
+
+  std::vector<line> parse(const std::string &text);
+
+  // fields joined by single spaces
+  std::string join(const std::vector<std::string> &fields);
+
+  std::string to_string(const std::vector<line> &lines);
+}
+
+#endif // __MANIFEST_HPP__
@@ -0,0 +1,417 @@
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include "../emu/cycle.hpp"
+#include "options.hpp"
+
+std::optional<options_t> parse_options(const int argc, const char *argv[]) {
+  options_t opts;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+
+    // fetch the value of an option that takes one
+    auto value = [&]() -> std::optional<std::string> {
+      if (i + 1 >= argc) {
+        std::cerr << arg << " requires a value\n";
+        return {};
+      }
+      return std::string(argv[++i]);
+    };
+
+    if (arg == "-h" || arg == "--help") {
+      print_usage(argv[0]);
+      return {};
+    } else if (arg == "--headless") {
+      opts.headless = true;
+    } else if (arg == "--cycles") {
+      auto v = value();
+      if (!v) { return {}; }
+      auto n = parse_size(*v);
+      if (!n) {
+        std::cerr << "invalid cycle count: " << *v << "\n";
+        return {};
+      }
+      opts.cycles = *n;
+    } else if (arg == "--lanes") {
+      auto v = value();
+      if (!v) { return {}; }
+      auto n = parse_size(*v);
+      if (!n || *n == 0) {
+        std::cerr << "invalid lane count: " << *v << "\n";
+        return {};
+      }
+      opts.lanes = *n;
+    } else if (arg == "--farm") {
+      opts.farm = true;
+    } else if (arg == "--script") {
+      auto v = value();
+      if (!v) { return {}; }
+      opts.script_paths.push_back(*v);
+    } else if (arg == "--jobs") {
+      auto v = value();
+      if (!v) { return {}; }
+      auto n = parse_size(*v);
+      if (!n) {
+        std::cerr << "invalid job count: " << *v << "\n";
+        return {};
+      }
+      opts.jobs = *n;
+    } else if (arg == "--timeout") {
+      auto v = value();
+      if (!v) { return {}; }
+      char *end = nullptr;
+      opts.timeout = std::strtod(v->c_str(), &end);
+      if (v->empty() || *end != '\0' || opts.timeout < 0.0) {
+        std::cerr << "invalid timeout: " << *v << "\n";
+        return {};
+      }
+    } else if (arg == "--report") {
+      auto v = value();
+      if (!v) { return {}; }
+      opts.report_path = *v;
+    } else if (arg == "--report-format") {
+      auto v = value();
+      if (!v) { return {}; }
+      if (*v == "csv") {
+        opts.report_format = report::format_t::csv;
+      } else if (*v == "json") {
+        opts.report_format = report::format_t::json;
+      } else {
+        std::cerr << "unknown report format: " << *v << "\n";
+        return {};
+      }
+    } else if (arg == "--fuzz") {
+      auto v = value();
+      if (!v) { return {}; }
+      opts.fuzz_dir = *v;
+    } else if (arg == "--fuzz-cycles") {
+      auto v = value();
+      if (!v) { return {}; }
+      auto n = parse_size(*v);
+      if (!n || *n == 0) {
+        std::cerr << "invalid cycle count: " << *v << "\n";
+        return {};
+      }
+      opts.fuzz_cycles = *n;
+    } else if (arg == "--fuzz-execs") {
+      auto v = value();
+      if (!v) { return {}; }
+      auto n = parse_size(*v);
+      if (!n) {
+        std::cerr << "invalid execution count: " << *v << "\n";
+        return {};
+      }
+      opts.fuzz_execs = *n;
+    } else if (arg == "--fuzz-seconds") {
+      auto v = value();
+      if (!v) { return {}; }
+      char *end = nullptr;
+      opts.fuzz_seconds = std::strtod(v->c_str(), &end);
+      if (v->empty() || *end != '\0' || opts.fuzz_seconds < 0.0) {
+        std::cerr << "invalid duration: " << *v << "\n";
+        return {};
+      }
+    } else if (arg == "--seed") {
+      auto v = value();
+      if (!v) { return {}; }
+      auto n = parse_size(*v);
+      if (!n) {
+        std::cerr << "invalid seed: " << *v << "\n";
+        return {};
+      }
+      opts.seed = *n;
+    } else if (arg == "--verify") {
+      auto v = value();
+      if (!v) { return {}; }
+      opts.verify_path = *v;
+    } else if (arg == "--update") {
+      opts.update = true;
+    } else if (arg == "--bench") {
+      opts.bench = true;
+    } else if (arg == "--bench-roms") {
+      auto v = value();
+      if (!v) { return {}; }
+      opts.bench_roms_path = *v;
+    } else if (arg == "--bench-iterations") {
+      auto v = value();
+      if (!v) { return {}; }
+      auto n = parse_size(*v);
+      if (!n || *n == 0) {
+        std::cerr << "invalid iteration count: " << *v << "\n";
+        return {};
+      }
+      opts.bench_iterations = *n;
+    } else if (arg == "--renderer") {
+      auto v = value();
+      if (!v) { return {}; }
+      if (*v == "soft") {
+        opts.backend = render::backend_t::soft;
+      } else if (*v == "curses") {
+        opts.backend = render::backend_t::curses;
+      #ifndef HEADLESS
+      } else if (*v == "gl") {
+        opts.backend = render::backend_t::gl;
+      #endif
+      } else {
+        std::cerr << "unknown renderer: " << *v << "\n";
+        return {};
+      }
+    } else if (arg == "--scale") {
+      auto v = value();
+      if (!v) { return {}; }
+      auto n = parse_size(*v);
+      if (!n || *n == 0) {
+        std::cerr << "invalid scale: " << *v << "\n";
+        return {};
+      }
+      opts.scale = *n;
+    #ifndef HEADLESS
+    } else if (arg == "--instances") {
+      auto v = value();
+      if (!v) { return {}; }
+      auto n = parse_size(*v);
+      if (!n || *n == 0) {
+        std::cerr << "invalid instance count: " << *v << "\n";
+        return {};
+      }
+      opts.instances = *n;
+    #endif
+    } else if (arg == "--frames") {
+      auto v = value();
+      if (!v) { return {}; }
+      opts.frame_dir = *v;
+    } else if (arg == "--frame-format") {
+      auto v = value();
+      if (!v) { return {}; }
+      if (*v == "ppm") {
+        opts.frame_format = render::frame_format_t::ppm;
+      } else if (*v == "png") {
+        opts.frame_format = render::frame_format_t::png;
+      } else {
+        std::cerr << "unknown frame format: " << *v << "\n";
+        return {};
+      }
+    } else if (arg == "--capture") {
+      auto v = value();
+      if (!v) { return {}; }
+      opts.capture_path = *v;
+    } else if (arg == "--capture-format") {
+      auto v = value();
+      if (!v) { return {}; }
+      if (*v == "y4m") {
+        opts.capture_format = capture::format_t::y4m;
+      } else if (*v == "rgb") {
+        opts.capture_format = capture::format_t::rgb;
+      } else {
+        std::cerr << "unknown capture format: " << *v << "\n";
+        return {};
+      }
+    } else if (arg == "--capture-scale") {
+      auto v = value();
+      if (!v) { return {}; }
+      auto n = parse_size(*v);
+      if (!n || *n == 0) {
+        std::cerr << "invalid capture scale: " << *v << "\n";
+        return {};
+      }
+      opts.capture_scale = *n;
+    } else if (arg == "--state") {
+      auto v = value();
+      if (!v) { return {}; }
+      opts.state_path = *v;
+    } else if (arg == "--load-state") {
+      opts.load_state = true;
+    } else if (arg == "--record") {
+      auto v = value();
+      if (!v) { return {}; }
+      opts.record_path = *v;
+    } else if (arg == "--replay") {
+      auto v = value();
+      if (!v) { return {}; }
+      opts.replay_path = *v;
+    } else if (arg == "--seek") {
+      auto v = value();
+      if (!v) { return {}; }
+      auto n = parse_size(*v);
+      if (!n) {
+        std::cerr << "invalid seek frame: " << *v << "\n";
+        return {};
+      }
+      opts.seek_frames.push_back(*n);
+    } else if (arg == "--control") {
+      auto v = value();
+      if (!v) { return {}; }
+      opts.control_path = *v;
+    } else if (arg == "--profile") {
+      auto v = value();
+      if (!v) { return {}; }
+      opts.profile_prefix = *v;
+    } else if (arg == "--opcode-stats") {
+      auto v = value();
+      if (!v) { return {}; }
+      opts.opcode_stats_path = *v;
+      #ifndef OPCODE_STATS
+      std::cerr << "built without OPCODE_STATS, --opcode-stats is ignored\n";
+      #endif
+    } else if (arg == "--trace") {
+      auto v = value();
+      if (!v) { return {}; }
+      opts.trace_path = *v;
+    } else if (arg == "--trace-size") {
+      auto v = value();
+      if (!v) { return {}; }
+      auto n = parse_size(*v);
+      if (!n || *n == 0) {
+        std::cerr << "invalid trace size: " << *v << "\n";
+        return {};
+      }
+      opts.trace_size = *n;
+    } else if (arg == "--decode-trace") {
+      auto v = value();
+      if (!v) { return {}; }
+      opts.decode_trace_path = *v;
+    } else if (arg == "--shm") {
+      auto v = value();
+      if (!v) { return {}; }
+      opts.shm_name = *v;
+    } else if (arg == "--run-ahead") {
+      auto v = value();
+      if (!v) { return {}; }
+      auto n = parse_size(*v);
+      if (!n || *n > emu::timer_frequency) {
+        std::cerr << "invalid run-ahead frame count: " << *v << "\n";
+        return {};
+      }
+      opts.run_ahead = *n;
+    } else if (arg == "--hud") {
+      opts.hud = true;
+    } else if (arg == "--rewind-seconds") {
+      auto v = value();
+      if (!v) { return {}; }
+      auto n = parse_size(*v);
+      if (!n) {
+        std::cerr << "invalid rewind length: " << *v << "\n";
+        return {};
+      }
+      opts.rewind_seconds = *n;
+    } else if (arg == "--rewind-memory") {
+      auto v = value();
+      if (!v) { return {}; }
+      auto n = parse_size(*v);
+      if (!n || *n == 0) {
+        std::cerr << "invalid rewind memory: " << *v << "\n";
+        return {};
+      }
+      opts.rewind_memory = *n;
+    } else if (!arg.empty() && arg[0] == '-') {
+      std::cerr << "unknown option: " << arg << "\n";
+      return {};
+    } else if (!opts.program_path) {
+      opts.program_path = arg;
+    } else {
+      std::cerr << "too many arguments\n";
+      return {};
+    }
+  }
+
+  if (opts.headless && !opts.program_path) {
+    std::cerr << "headless mode requires a program path\n";
+    return {};
+  }
+
+  if (opts.record_path && opts.replay_path) {
+    std::cerr << "--record and --replay cannot be combined\n";
+    return {};
+  }
+
+  // clients can load programs and states, which recordings cannot follow
+  if (opts.control_path && (opts.record_path || opts.replay_path)) {
+    std::cerr << "--control cannot be combined with --record or --replay\n";
+    return {};
+  }
+
+  // the program menu writes to stdout
+  if (opts.capture_path == "-" && !opts.program_path) {
+    std::cerr << "capturing to stdout requires a program path\n";
+    return {};
+  }
+
+  // so do headless run results and the curses renderer
+  if (opts.capture_path == "-" && opts.headless) {
+    std::cerr << "--headless cannot capture to stdout\n";
+    return {};
+  }
+  if (opts.capture_path == "-" && opts.backend == render::backend_t::curses) {
+    std::cerr << "--renderer curses cannot capture to stdout\n";
+    return {};
+  }
+
+  return opts;
+}
+
+void print_usage(const char *name) {
+  std::cerr
+    << "usage: " << name << " [options] [program.ch8]\n"
+    << "  --headless             run unthrottled without display or input\n"
+    << "  --cycles N             cycle budget of headless, farm and soft runs\n"
+    << "  --lanes N              headless run of N copies in lockstep\n"
+    << "  --farm                 run every installed rom headless in parallel\n"
+    << "  --script FILE          farm input script, repeat for more\n"
+    << "  --jobs N               farm worker threads\n"
+    << "  --timeout SECONDS      farm wall clock limit per run\n"
+    << "  --report PATH          farm report, stdout by default\n"
+    << "  --report-format csv|json\n"
+    << "  --fuzz DIR             fuzz the vm, results in DIR\n"
+    << "  --fuzz-cycles N        cycle budget per fuzz execution\n"
+    << "  --fuzz-execs N         stop after N executions\n"
+    << "  --fuzz-seconds S       stop after S seconds\n"
+    << "  --seed N               fuzzer and CXNN random seed\n"
+    << "  --verify MANIFEST      check framebuffers against golden hashes\n"
+    << "  --update               record golden hashes or bench thresholds\n"
+    << "  --bench                time every opcode class, json on stdout\n"
+    << "  --bench-iterations N   iterations per opcode and repeat\n"
+    << "  --bench-roms MANIFEST  rom throughput benchmark with thresholds\n"
+    << "  --renderer gl|soft|curses display backend\n"
+    << "  --instances N          run N machines in one gl window\n"
+    << "  --scale N              software renderer pixel scale\n"
+    << "  --frames DIR           write software rendered frames to DIR\n"
+    << "  --frame-format ppm|png image format used by --frames\n"
+    << "  --capture PATH         stream every frame to PATH, - for stdout\n"
+    << "  --capture-format y4m|rgb\n"
+    << "  --capture-scale N      integer scale of captured frames\n"
+    << "  --state FILE           save state file used by f5 and f9\n"
+    << "  --load-state           start from the most recent save state\n"
+    << "  --record FILE          record key changes to a movie file\n"
+    << "  --replay FILE          play a movie file back, also headless\n"
+    << "  --seek FRAME           headless jump to a 60hz frame, repeat for more\n"
+    << "  --control SOCKET       serve automation clients on a unix socket\n"
+    << "  --profile PREFIX       write PREFIX.txt and PREFIX.folded profiles\n"
+    << "  --opcode-stats FILE    json opcode histogram (OPCODE_STATS builds)\n"
+    << "  --trace FILE           binary trace of the last instructions run\n"
+    << "  --trace-size N         instructions kept by --trace\n"
+    << "  --decode-trace FILE    print a trace file as text\n"
+    << "  --shm NAME             mirror the machine into shared memory\n"
+    << "  --run-ahead N          show frames N frames ahead to hide input lag\n"
+    << "  --hud                  show frame times and speed, f3 toggles it\n"
+    << "  --rewind-seconds N     rewind history length, 0 disables it\n"
+    << "  --rewind-memory KIB    memory limit of the rewind history\n";
+}
+
+std::optional<std::size_t> parse_size(const std::string &s) {
+  if (s.empty() || s.find_first_not_of("0123456789") != std::string::npos) {
+    return {};
+  }
+
+  errno = 0;
+  const unsigned long long n = std::strtoull(s.c_str(), nullptr, 10);
+  if (errno == ERANGE) {
+    return {};
+  }
+
+  return n;
+}
@@ -0,0 +1,124 @@
+#ifndef __OPTIONS_HPP__
+#define __OPTIONS_HPP__
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../capture/frame_writer.hpp"
+#include "../render/renderer.hpp"
+#include "../render/soft_renderer.hpp"
+#include "report.hpp"
+
+struct options_t {
+  // run without display, input or pacing, see modes::run_headless
+  bool headless = false;
+  uint64_t cycles = 1000000;
+  std::size_t lanes = 1; // copies run in lockstep, see emu::Batch
+
+  #ifdef HEADLESS
+  render::backend_t backend = render::backend_t::soft;
+  #else
+  render::backend_t backend = render::backend_t::gl;
+  #endif
+
+  // rom farm, see modes::run_farm
+  bool farm = false;
+  std::vector<std::string> script_paths;
+  std::size_t jobs = 0; // 0 = one per hardware thread
+  double timeout = 0.0; // wall clock seconds per run, 0 = none
+  std::optional<std::string> report_path;
+  report::format_t report_format = report::format_t::csv;
+
+  // rom fuzzer, see modes::run_fuzz
+  std::optional<std::string> fuzz_dir;
+  uint64_t fuzz_cycles = 5000; // per execution
+  uint64_t fuzz_execs = 0; // 0 = no limit
+  double fuzz_seconds = 0.0; // 0 = no limit
+
+  // fuzzer and CXNN random seed, interactive runs pick one when unset and
+  // everything else uses emu::default_seed
+  std::optional<uint64_t> seed;
+
+  // golden framebuffer checks, see modes::run_verify
+  std::optional<std::string> verify_path;
+
+  // rewrite golden hashes or benchmark thresholds from this run
+  bool update = false;
+
+  // opcode microbenchmarks, see modes::run_opcode_bench
+  bool bench = false;
+  uint64_t bench_iterations = 1000000;
+
+  // rom throughput benchmark, see modes::run_rom_bench
+  std::optional<std::string> bench_roms_path;
+
+  // software renderer
+  std::size_t scale = 1;
+  std::optional<std::string> frame_dir;
+  render::frame_format_t frame_format = render::frame_format_t::ppm;
+
+  // number of machines shown side by side by the gl wall renderer
+  std::size_t instances = 1;
+
+  // raw frame capture, "-" for stdout
+  std::optional<std::string> capture_path;
+  capture::format_t capture_format = capture::format_t::y4m;
+  std::size_t capture_scale = 1;
+
+  // save state file, the program's file in the data directory by default
+  std::optional<std::string> state_path;
+  bool load_state = false; // start from the most recent save state
+
+  // key changes of an interactive run are written to record_path, replay_path
+  // plays a recording back in place of host input
+  std::optional<std::string> record_path;
+  std::optional<std::string> replay_path;
+
+  // headless replays jump to each of these frames, see emu::Seeker
+  std::vector<uint64_t> seek_frames;
+
+  // unix socket for automation clients, see control::Server
+  std::optional<std::string> control_path;
+
+  // shared memory segment mirroring the machine, see control::SharedState
+  std::optional<std::string> shm_name;
+
+  // frames the display runs ahead of the machine, 0 disables it
+  std::size_t run_ahead = 0;
+
+  // frame time overlay shown from the start, f3 toggles it
+  bool hud = false;
+
+  // rewind history, 0 seconds disables it
+  std::size_t rewind_seconds = 60;
+  std::size_t rewind_memory = 1024; // kib
+
+  // hot pc, loop and subroutine report of a run, written to <prefix>.txt
+  // with folded call stacks in <prefix>.folded, see emu::Profiler
+  std::optional<std::string> profile_prefix;
+
+  // json opcode histogram, written on exit and on f6; needs an OPCODE_STATS
+  // build, see emu::OpcodeReport
+  std::optional<std::string> opcode_stats_path;
+
+  // the last trace_size instructions of a run are written to trace_path on
+  // exit, see emu::TraceRing; decode_trace_path prints a trace file as text
+  std::optional<std::string> trace_path;
+  std::size_t trace_size = 1 << 18;
+  std::optional<std::string> decode_trace_path;
+
+  // skips the program menu when set
+  std::optional<std::string> program_path;
+};
+
+// decimal digits only
+std::optional<std::size_t> parse_size(const std::string &s);
+
+// prints a message to stderr and returns nothing on bad arguments
+std::optional<options_t> parse_options(const int argc, const char *argv[]);
+
+void print_usage(const char *name);
+
+#endif // __OPTIONS_HPP__
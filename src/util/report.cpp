@@ -0,0 +1,81 @@
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "report.hpp"
+
+static std::string csv_escape(const std::string &s);
+
+void report::write(std::ostream &os, const table &t, const format_t format) {
+  if (format == format_t::csv) {
+    for (std::size_t c = 0; c < t.columns.size(); c++) {
+      os << (c ? "," : "") << csv_escape(t.columns[c]);
+    }
+    os << "\n";
+
+    for (const auto &row : t.rows) {
+      for (std::size_t c = 0; c < row.size(); c++) {
+        os << (c ? "," : "") << csv_escape(row[c]);
+      }
+      os << "\n";
+    }
+
+    return;
+  }
+
+  os << "[\n";
+  for (std::size_t r = 0; r < t.rows.size(); r++) {
+    const auto &row = t.rows[r];
+    os << "  {";
+    for (std::size_t c = 0; c < row.size(); c++) {
+      os << (c ? ", " : "") << "\"" << json_escape(t.columns[c]) << "\": ";
+      if (c < t.numeric.size() && t.numeric[c]) {
+        os << row[c];
+      } else {
+        os << "\"" << json_escape(row[c]) << "\"";
+      }
+    }
+    os << "}" << ((r + 1 < t.rows.size()) ? "," : "") << "\n";
+  }
+  os << "]\n";
+}
+
+std::string report::json_escape(const std::string &s) {
+  std::string out;
+  out.reserve(s.size());
+
+  for (const char ch : s) {
+    switch (ch) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(ch) < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", ch);
+          out += buf;
+        } else {
+          out += ch;
+        }
+    }
+  }
+
+  return out;
+}
+
+static std::string csv_escape(const std::string &s) {
+  if (s.find_first_of(",\"\n") == std::string::npos) {
+    return s;
+  }
+
+  std::string out = "\"";
+  for (const char ch : s) {
+    if (ch == '"') { out += '"'; }
+    out += ch;
+  }
+  out += "\"";
+
+  return out;
+}
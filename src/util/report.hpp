@@ -0,0 +1,25 @@
+#ifndef __REPORT_HPP__
+#define __REPORT_HPP__
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace report {
+  enum class format_t {
+    csv,
+    json
+  };
+
+  // a table of string cells, numeric columns are written unquoted in json
+  struct table {
+    std::vector<std::string> columns;
+    std::vector<bool> numeric;
+    std::vector<std::vector<std::string>> rows;
+  };
+
+  void write(std::ostream &os, const table &t, const format_t format);
+
+  std::string json_escape(const std::string &s);
+}
+
+#endif // __REPORT_HPP__
@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "thread_pool.hpp"
+
+util::ThreadPool::ThreadPool(std::size_t workers) {
+  if (workers == 0) {
+    workers = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  for (std::size_t i = 0; i < workers; i++) {
+    queues.push_back(std::make_unique<queue_t>());
+  }
+  for (std::size_t i = 0; i < workers; i++) {
+    threads.emplace_back(&ThreadPool::run, this, i);
+  }
+}
+
+util::ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  work_available.notify_all();
+
+  for (auto &t : threads) {
+    t.join();
+  }
+}
+
+std::size_t util::ThreadPool::size() const {
+  return threads.size();
+}
+
+void util::ThreadPool::submit(task_t task) {
+  queue_t &q = *queues[next];
+  next = (next + 1) % queues.size();
+
+  {
+    std::lock_guard<std::mutex> lock(q.mutex);
+    q.tasks.push_back(std::move(task));
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queued++;
+    pending++;
+  }
+  work_available.notify_one();
+}
+
+void util::ThreadPool::wait() {
+  std::unique_lock<std::mutex> lock(mutex);
+  all_done.wait(lock, [this](){ return pending == 0; });
+}
+
+void util::ThreadPool::run(const std::size_t index) {
+  task_t task;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      work_available.wait(lock, [this](){ return queued > 0 || stopping; });
+      if (queued == 0) { return; }
+      queued--;
+    }
+
+    // a task is guaranteed to be queued somewhere, find it
+    while (!pop(index, task)) {
+      std::this_thread::yield();
+    }
+
+    task(index);
+    task = nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (--pending == 0) {
+      all_done.notify_all();
+    }
+  }
+}
+
+bool util::ThreadPool::pop(const std::size_t index, task_t &task) {
+  {
+    queue_t &own = *queues[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+
+  for (std::size_t i = 1; i < queues.size(); i++) {
+    queue_t &other = *queues[(index + i) % queues.size()];
+    std::lock_guard<std::mutex> lock(other.mutex);
+    if (!other.tasks.empty()) {
+      task = std::move(other.tasks.front());
+      other.tasks.pop_front();
+      return true;
+    }
+  }
+
+  return false;
+}
@@ -0,0 +1,56 @@
+#ifndef __THREAD_POOL_HPP__
+#define __THREAD_POOL_HPP__
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util {
+  // work stealing pool: each worker owns a queue and pops from its back,
+  // idle workers steal from the front of the others
+  class ThreadPool {
+  public:
+    using task_t = std::function<void(const std::size_t worker)>;
+
+    explicit ThreadPool(std::size_t workers=0); // 0 = hardware threads
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    std::size_t size() const;
+
+    // tasks are spread round robin, `worker` is the index of the thread
+    // that ends up running it; only call from one thread
+    void submit(task_t task);
+
+    // blocks until every submitted task has finished
+    void wait();
+  private:
+    struct queue_t {
+      std::mutex mutex;
+      std::deque<task_t> tasks;
+    };
+
+    void run(const std::size_t index);
+    bool pop(const std::size_t index, task_t &task);
+
+    std::vector<std::unique_ptr<queue_t>> queues;
+    std::vector<std::thread> threads;
+    std::size_t next = 0;
+
+    std::mutex mutex;
+    std::condition_variable work_available;
+    std::condition_variable all_done;
+    std::size_t queued = 0;
+    std::size_t pending = 0;
+    bool stopping = false;
+  };
+}
+
+#endif // __THREAD_POOL_HPP__